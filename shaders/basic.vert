@@ -8,8 +8,34 @@ layout(location = 1) in vec3 aNormal; //attribute normal
 layout(location = 2) in vec2 aTexCoords; //attribute_texCoords
 
 uniform mat4 uM_m = mat4(1.0);//uniform mat4 model;
-uniform mat4 uV_m = mat4(1.0);//uniform mat4 view;
-uniform mat4 uP_m = mat4(1.0);//uniform mat4 projection;
+uniform mat3 uN_m = mat3(1.0);//normal matrix, precomputed on CPU
+
+// packed meshes store positions as unorm16 inside the mesh AABB (Mesh::bind_format)
+uniform vec3 uPosScale = vec3(1.0);
+uniform vec3 uPosOffset = vec3(0.0);
+
+// per-frame constants, shared by all programs (FrameConstants in FrameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameBlock {
+    mat4 uV_m;      // view
+    mat4 uP_m;      // projection
+    mat4 uVP_m;     // projection * view, precomputed on CPU
+    vec4 uViewPos;  // camera position
+    vec4 uScreen;   // width, height, near, far
+};
+
+// instanced rendering - per-instance matrices instead of uM_m / uN_m
+struct InstanceData {
+    mat4 model;
+    mat4 normal; // mat3 padded to mat4
+};
+
+layout(std430, binding = 0) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
+
+uniform int uInstanced = 0;
+
+uniform int uMaterial = -1; // MaterialTextures index, -1 = tex0
 
 
 
@@ -17,16 +43,30 @@ out VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoord;
+    flat int Material;
 } vs_out;
 
 uniform float tex_scale = 1.0f; // scale factor for texture coordinates
 
 void main() {
 
-    vec4 worldPos = uM_m * vec4(aPos, 1.0);
+    mat4 model = uM_m;
+    mat3 normalMatrix = uN_m;
+    int material = uMaterial;
+    if (uInstanced == 1) {
+        model = instances[gl_BaseInstance + gl_InstanceID].model;
+        normalMatrix = mat3(instances[gl_BaseInstance + gl_InstanceID].normal);
+        // GPU driven batches mix materials, the index travels in the padding column
+        int instanceMaterial = int(instances[gl_BaseInstance + gl_InstanceID].normal[3].x) - 1;
+        if (instanceMaterial >= 0)
+            material = instanceMaterial;
+    }
+    vs_out.Material = material;
+
+    vec4 worldPos = model * vec4(aPos * uPosScale + uPosOffset, 1.0);
     vs_out.FragPos = worldPos.xyz;
-    vs_out.Normal = mat3(transpose(inverse(uM_m))) * aNormal;
+    vs_out.Normal = normalMatrix * aNormal;
     vs_out.TexCoord = aTexCoords * tex_scale; // násobení opakování textury;
 
-    gl_Position = uP_m * uV_m * worldPos;
+    gl_Position = uVP_m * worldPos;
 }
@@ -1,6 +1,13 @@
 #version 460 core
+#extension GL_ARB_bindless_texture : enable
 #define MAX_TEAPOTS 4
 
+// clustered lighting grid, must match ClusteredLighting.hpp
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+#define MAX_LIGHTS_PER_CLUSTER 128
+
 struct DirectionalLight {
     vec3 direction;
     vec3 diffuse;
@@ -39,54 +46,135 @@ struct EmissiveLight {
 };
 
 
-uniform int SpotlightLightOn;             // zapnut� / vypnut�
-uniform int pointLightOn;
-uniform int directionalLightOn;
-
 in VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoord;
+    flat int Material;
 } fs_in;
 
-uniform PointLight teapotLight[MAX_TEAPOTS];
-uniform SpotlightLight spotLight;
-uniform DirectionalLight directionLight;
+// per-frame constants, shared by all programs (FrameConstants in FrameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameBlock {
+    mat4 uV_m;
+    mat4 uP_m;
+    mat4 uVP_m;
+    vec4 uViewPos;
+    vec4 uScreen;   // width, height, near, far
+};
+
+// all lights, std140 (LightConstants in FrameUniforms.hpp)
+layout(std140, binding = 1) uniform LightBlock {
+    PointLight teapotLight[MAX_TEAPOTS];
+    EmissiveLight teapotEmissive[MAX_TEAPOTS];
+    SpotlightLight spotLight;
+    DirectionalLight directionLight;
+    EmissiveLight sunEmissive;
+    vec3 ambient;
+    int teapotCount;
+    int SpotlightLightOn;             // zapnut� / vypnut�
+    int pointLightOn;
+    int directionalLightOn;
+};
+
+// clustered lighting - lights assigned to clusters by cluster_lights.comp
+struct ClusterLight {
+    vec4 positionRadius;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation; // constant, linear, exponent
+};
+
+layout(std430, binding = 5) readonly buffer LightBuffer {
+    ClusterLight clusterLights[];
+};
 
-uniform vec3 viewPos;
+layout(std430, binding = 6) readonly buffer LightGrid {
+    uint clusterLightCount[];
+};
+
+layout(std430, binding = 7) readonly buffer LightIndices {
+    uint clusterLightIndex[];
+};
+
+uniform int uClustered = 0;
+
+// compile time variants (ShaderProgram::select), each switch without a define stays a runtime branch
+#ifdef SPOT_LIGHT
+#define SPOT_LIGHT_ON (SPOT_LIGHT != 0)
+#else
+#define SPOT_LIGHT_ON (SpotlightLightOn == 1)
+#endif
+#ifdef SUN_LIGHT
+#define SUN_LIGHT_ON (SUN_LIGHT != 0)
+#else
+#define SUN_LIGHT_ON (directionalLightOn == 1)
+#endif
+#ifdef POINT_LIGHTS // teapot count, the loop unrolls
+#define POINT_LIGHTS_ON true
+#define POINT_LIGHT_COUNT min(POINT_LIGHTS, MAX_TEAPOTS)
+#else
+#define POINT_LIGHTS_ON (pointLightOn == 1)
+#define POINT_LIGHT_COUNT teapotCount
+#endif
+#ifdef CLUSTERED
+#define CLUSTERED_ON (CLUSTERED != 0)
+#else
+#define CLUSTERED_ON (uClustered == 1)
+#endif
 
 uniform sampler2D tex0;
+
+// material table (MaterialTextures.hpp), used when fs_in.Material >= 0
+uniform int uTextureMode = 0; // 1 = array, 2 = bindless
+uniform sampler2DArray uTexArray;
+#ifdef GL_ARB_bindless_texture
+layout(std430, binding = 8) readonly buffer MaterialHandles {
+    uvec2 materialHandles[];
+};
+#endif
 uniform vec3 matAmbient;
 uniform vec3 matSpecular;
 uniform float matShininess;
+uniform float matOpacity = 1.0;
 
-// sun
-uniform EmissiveLight sunEmissive;
+// weighted blended OIT pass, accumulation + revealage targets instead of blending in order
+uniform int uOitPass = 0;
 
-// teapots
-uniform EmissiveLight teapotEmissive[MAX_TEAPOTS];
-uniform int teapotCount;
-
-// ambient light
-uniform vec3 ambient;
-out vec4 frag_color;
+layout(location = 0) out vec4 frag_color;
+layout(location = 1) out float frag_revealage;
 
 vec3 calc_spotlight_light();
 vec3 calc_point_light(PointLight light);
 vec3 calc_directional_light();
+vec3 calc_clustered_lights();
+
+vec4 sample_albedo(vec2 uv) {
+    if (fs_in.Material < 0)
+        return texture(tex0, uv);
+#ifdef GL_ARB_bindless_texture
+    if (uTextureMode == 2)
+        return texture(sampler2D(materialHandles[fs_in.Material]), uv);
+#endif
+    return texture(uTexArray, vec3(uv, float(fs_in.Material)));
+}
 
 void main() {
     // apply ambient light to base color
     vec3 finalColor = (matAmbient + ambient);
 
     // add SpotlightLight only if enabled
-    if (SpotlightLightOn == 1) {
+    if (SPOT_LIGHT_ON) {
         finalColor += calc_spotlight_light();
     }
 
-    if (pointLightOn == 1) {
-        for (int i = 0; i < teapotCount; i++) {
-            finalColor += calc_point_light(teapotLight[i]);
+    if (POINT_LIGHTS_ON) {
+        // teapot lights are part of cluster light list in clustered mode
+        if (CLUSTERED_ON)
+            finalColor += calc_clustered_lights();
+
+        for (int i = 0; i < POINT_LIGHT_COUNT; i++) {
+            if (!CLUSTERED_ON)
+                finalColor += calc_point_light(teapotLight[i]);
 
             // Add emissive effect for teapots
             float dist = length(teapotEmissive[i].position - fs_in.FragPos);
@@ -95,7 +183,7 @@ void main() {
         }
     }
 
-    if (directionalLightOn == 1)
+    if (SUN_LIGHT_ON)
         // add directional light = sun
         finalColor += calc_directional_light();
 
@@ -106,7 +194,18 @@ void main() {
     //finalColor += sunEmissiveColor * 1.0;
 
     //adding textures and putting it in the frag_color
-    frag_color = vec4(finalColor, 1.0) * texture(tex0, fs_in.TexCoord);
+    vec4 color = vec4(finalColor, 1.0) * sample_albedo(fs_in.TexCoord);
+    color.a *= matOpacity;
+
+    if (uOitPass == 1) {
+        // depth weight, McGuire & Bavoil 2013 eq. 10 (clip depth based)
+        float weight = clamp(pow(min(1.0, color.a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+        frag_color = vec4(color.rgb * color.a, color.a) * weight;
+        frag_revealage = color.a;
+    } else {
+        frag_color = color;
+        frag_revealage = color.a;
+    }
 }
 
 vec3 calc_spotlight_light() {
@@ -120,7 +219,7 @@ vec3 calc_spotlight_light() {
     float NdotL = max(dot(normal, lightDir), 0.0);
     vec3 diffuse = spotLight.diffuse * NdotL;
 
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(uViewPos.xyz - fs_in.FragPos);
     vec3 halfDir = normalize(lightDir + viewDir);
     float NDotH = max(dot(normal, halfDir), 0.0);
     vec3 specular = spotLight.specular * matSpecular * pow(NDotH, matShininess);
@@ -134,7 +233,7 @@ vec3 calc_spotlight_light() {
 
 vec3 calc_point_light(PointLight light) {
     vec3 normal = normalize(fs_in.Normal);
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(uViewPos.xyz - fs_in.FragPos);
     vec3 fragPos = fs_in.FragPos;
 
     vec3 lightDir = normalize(light.position - fragPos);
@@ -165,11 +264,42 @@ vec3 calc_directional_light() {
     vec3 diffuse = directionLight.diffuse * diff;
 
     // Specular
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(uViewPos.xyz - fs_in.FragPos);
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), matShininess);
     vec3 specular = directionLight.specular * spec * matSpecular;
 
     // No attenuation for directional light
     return diffuse + specular;
-}
\ No newline at end of file
+}
+
+vec3 calc_clustered_lights() {
+    // cluster of this fragment - screen tile + exponential depth slice
+    float viewDepth = -(uV_m * vec4(fs_in.FragPos, 1.0)).z;
+    float zNear = uScreen.z;
+    float zFar = uScreen.w;
+    int slice = int(floor(log(viewDepth / zNear) / log(zFar / zNear) * CLUSTER_Z));
+    ivec2 tile = ivec2(gl_FragCoord.xy / uScreen.xy * vec2(CLUSTER_X, CLUSTER_Y));
+    ivec3 cluster = clamp(ivec3(tile, slice), ivec3(0), ivec3(CLUSTER_X - 1, CLUSTER_Y - 1, CLUSTER_Z - 1));
+    uint clusterIndex = uint(cluster.x + cluster.y * CLUSTER_X + cluster.z * CLUSTER_X * CLUSTER_Y);
+
+    vec3 result = vec3(0.0);
+    uint count = clusterLightCount[clusterIndex];
+    for (uint i = 0; i < count; ++i) {
+        ClusterLight cl = clusterLights[clusterLightIndex[clusterIndex * MAX_LIGHTS_PER_CLUSTER + i]];
+
+        PointLight light;
+        light.position = cl.positionRadius.xyz;
+        light.diffuse = cl.diffuse.rgb;
+        light.specular = cl.specular.rgb;
+        light.constant = cl.attenuation.x;
+        light.linear = cl.attenuation.y;
+        light.exponent = cl.attenuation.z;
+
+        // smooth falloff to zero at light radius, hides cluster borders
+        float ratio = length(light.position - fs_in.FragPos) / cl.positionRadius.w;
+        float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+        result += calc_point_light(light) * window * window;
+    }
+    return result;
+}
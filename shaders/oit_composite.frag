@@ -0,0 +1,22 @@
+#version 460 core
+
+// weighted blended OIT resolve (McGuire & Bavoil 2013)
+// blended over the opaque image with glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA)
+
+in vec2 vTexCoord;
+
+uniform sampler2D uAccum;     // sum of weighted premultiplied color, weighted alpha in .a
+uniform sampler2D uRevealage; // product of (1 - alpha)
+
+out vec4 frag_color;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(uRevealage, texel, 0).r;
+    if (revealage >= 1.0)
+        discard; // no transparent surface here
+
+    vec4 accum = texelFetch(uAccum, texel, 0);
+    vec3 average = accum.rgb / clamp(accum.a, 1e-4, 5e4);
+    frag_color = vec4(average, revealage);
+}
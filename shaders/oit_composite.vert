@@ -0,0 +1,11 @@
+#version 460 core
+
+// fullscreen triangle from gl_VertexID, no vertex buffer needed
+
+out vec2 vTexCoord;
+
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vTexCoord = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
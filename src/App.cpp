@@ -5,15 +5,29 @@
 #include <imgui_impl_opengl3.h>
 #include <fstream>
 #include <thread>
+#include <chrono>
+#include <algorithm>
+#include <array>
 
 #include "App.hpp"
 #include "Collision.hpp"
 #include "gl_err_callback.hpp"
+#include "JobGraph.hpp"
 #include "Logger.hpp"
 #include "MazeGenerator.hpp"
+#include "MazeMeshBuilder.hpp"
+#include "MeshCache.hpp"
+#include "TextureBaker.hpp"
+#include "TextureStreamer.hpp"
 
 const size_t maze_width = 32;
 const size_t maze_depth = 32;
+constexpr int MAX_TEAPOTS = 2; // teapots that light the scene, LightBlock has room for 4
+
+// parsed / decoded on worker threads during startup, init_assets() takes them from the ResourceManager
+const char* const startup_meshes[] = {"assets/objects/cube_triangles_vnt.obj", "assets/objects/teapot.obj"};
+const char* const startup_textures[] = {"assets/textures/ground.png", "assets/textures/teapot.png", "assets/textures/yellow.jpg",
+                                        "assets/textures/wall.png", "assets/textures/red.jpg"};
 
 App::App():
         m_Camera(std::make_unique<Camera>(glm::vec3(0, 0, 2))),
@@ -21,75 +35,133 @@ App::App():
     m_Collision = std::make_unique<Collision>(m_Map,  0.25f);
 }
 
-bool App::init() {
-    load_config();
-    try {
-        glfwSetErrorCallback(error_callback);
-      
-        if (!glfwInit()) {
-            return false;
-        }
+void App::init_context() {
+    glfwSetErrorCallback(error_callback);
+  
+    if (!glfwInit())
+        throw std::runtime_error("GLFW init failed");
+
+    // Set OpenGL version
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_SAMPLES, antialiasing_enabled ? 4 : 0);
+    glfwWindowHint(GLFW_DEPTH_BITS, 24);  // depth buffer
+
+    // open window (GL canvas) with no special properties
+    window = glfwCreateWindow(win_width, win_height, "OpenGL context", fullscreen ? glfwGetPrimaryMonitor() : NULL, NULL);
+    if (!window) {
+        glfwTerminate();
+        throw std::runtime_error("Window creation failed");
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetWindowUserPointer(window, this);
+    glfwSetKeyCallback(window, key_callback);
 
-        // Set OpenGL version
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-        glfwWindowHint(GLFW_SAMPLES, antialiasing_enabled ? 4 : 0);
-        glfwWindowHint(GLFW_DEPTH_BITS, 24);  // depth buffer
-
-        // open window (GL canvas) with no special properties
-        window = glfwCreateWindow(win_width, win_height, "OpenGL context", fullscreen ? glfwGetPrimaryMonitor() : NULL, NULL);
-        if (!window) {
-            glfwTerminate();
-            return false;
-        }
-        glfwMakeContextCurrent(window);
-        glfwSetWindowUserPointer(window, this);
-        glfwSetKeyCallback(window, key_callback);
+    // disable cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-        // disable cursor
-        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    print_gl_info();
 
-        print_gl_info();
+    // vsync
+    glfwSwapInterval(vsync_enabled ? 1 : 0);
 
-        // vsync
-        glfwSwapInterval(vsync_enabled ? 1 : 0);
+    GLenum err = glewInit();
+    if (GLEW_OK != err) {
+        Logger::error("Error: " + std::string(reinterpret_cast<const char *>(glewGetErrorString(err))));
+    }
+    glewInit();
 
-        GLenum err = glewInit();
-        if (GLEW_OK != err) {
-            Logger::error("Error: " + std::string(reinterpret_cast<const char *>(glewGetErrorString(err))));
-        }
-        glewInit();
+    if (antialiasing_enabled)
+        glEnable(GL_MULTISAMPLE);  // antialiasing
 
-        if (antialiasing_enabled)
-            glEnable(GL_MULTISAMPLE);  // antialiasing
+    glEnable(GL_DEPTH_TEST);        // draw depth - Z buffer
+    glDepthFunc(GL_LESS);
 
-        glEnable(GL_DEPTH_TEST);        // draw depth - Z buffer
-        glDepthFunc(GL_LESS);
+    glDebugMessageCallback(MessageCallback, 0);
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_CULL_FACE);
 
-        glDebugMessageCallback(MessageCallback, 0);
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_CULL_FACE);
+    if (!GLEW_ARB_direct_state_access)
+        throw std::runtime_error("No DSA :-(");
+    ShaderProgram::init_parallel_compile();
 
-        if (!GLEW_ARB_direct_state_access)
-            throw std::runtime_error("No DSA :-(");
 
+    glfwSetFramebufferSizeCallback(window, fbsize_callback);    // On GL framebuffer resize callback.
+    glfwSetScrollCallback(window, scroll_callback);             // On mouse wheel.
+    glfwSetCursorPosCallback(window, cursor_position_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
 
-        glfwSetFramebufferSizeCallback(window, fbsize_callback);    // On GL framebuffer resize callback.
-        glfwSetScrollCallback(window, scroll_callback);             // On mouse wheel.
-        glfwSetCursorPosCallback(window, cursor_position_callback);
-        glfwSetMouseButtonCallback(window, mouse_button_callback);
-        
-        MazeGenerator maze_generator(maze_depth, maze_width);
-        glm::vec2 start = glm::vec2(1, 1);
-        glm::vec2 end = glm::vec2(maze_depth - 3, maze_width - 3);
-        maze_generator.generate(this->m_Map, start, end);
+    if (texture_streaming)
+        TextureStreamer::init(static_cast<size_t>(std::max(texture_upload_budget_kb, 1)) * 1024);
+    // array layers are the only copy of a material texture, each file is baked once at the layer size
+    texture_binding = MaterialTextures::resolve(texture_binding);
+    if (texture_binding == TextureBinding::Array)
+        ResourceManager::texture_layer_size = MaterialTextures::LAYER_SIZE;
+}
+
+bool App::init() {
+    m_StartTime = std::chrono::steady_clock::now();
+    load_config();
+    try {
+        // startup as a job graph, GL work stays on this thread, parsing and decoding go to workers
+        using Thread = JobGraph::Thread;
+        JobGraph startup;
+        const auto context = startup.add("context", "window + GL", Thread::Main, [this] { init_context(); });
+        std::vector<JobGraph::JobId> assets{context};
+        assets.push_back(startup.add("maze", "generate", Thread::Worker, [this] {
+            MazeGenerator maze_generator(maze_depth, maze_width);
+            glm::vec2 start = glm::vec2(1, 1);
+            glm::vec2 end = glm::vec2(maze_depth - 3, maze_width - 3);
+            maze_generator.generate(this->m_Map, start, end);
+        }));
+        for (const char* path : startup_meshes)
+            assets.push_back(startup.add("meshes", path, Thread::Worker, [path] { ResourceManager::prefetch_mesh(path); }));
+        // streamed textures are decoded by the streamer, the baker needs GL extensions to pick the format
+        // and the layer size of the material table
+        if (!texture_streaming)
+            for (const char* path : startup_textures)
+                assets.push_back(startup.add("textures", path, Thread::Worker, [path] { ResourceManager::prefetch_texture(path); }, {context}));
+        // every program is submitted at once and compiled by the driver threads while the scene is built,
+        // the subsystems take their own references, these only keep the programs alive until then
+        std::vector<ProgramResource> startup_programs;
+        assets.push_back(startup.add("shaders", "submit", Thread::Main, [this, &startup_programs] {
+            m_Program = ResourceManager::load_program("shaders/basic.vert", "shaders/better.frag");
+            if (gpu_driven) {
+                startup_programs.push_back(ResourceManager::load_program("shaders/cull.comp"));
+                startup_programs.push_back(ResourceManager::load_program("shaders/depth_reduce.comp"));
+            }
+            if (oit)
+                startup_programs.push_back(ResourceManager::load_program("shaders/oit_composite.vert", "shaders/oit_composite.frag"));
+            if (clustered_lighting)
+                startup_programs.push_back(ResourceManager::load_program("shaders/cluster_lights.comp"));
+        }, {context}));
+        startup.add("scene", "init_assets", Thread::Main, [this] { init_assets(); }, assets);
+        startup.run();
+        startup.log_timings();
+        for (const ProgramResource program : startup_programs)
+            ResourceManager::release(program);
+
+        if (shader_hot_reload)
+            m_ShaderWatcher = std::make_unique<ShaderWatcher>("shaders");
+        // flashlight and sun toggle at runtime, built by the driver threads before they are needed
+        if (shader_variants) {
+            const int point_lights = std::min(static_cast<int>(m_Teapots.size()), MAX_TEAPOTS);
+            for (const bool spot : {false, true})
+                for (const bool sun : {false, true})
+                    shader().prewarm(light_variant(spot, sun, point_lights));
+        }
 
         m_Camera->m_position = glm::vec3(-10, 1.0f, -10);
 
         //init_assets("resources"); // transparent and non-transparent models
 
-        init_assets();
+        GLState::invalidate();
+        for (const auto& [kind, stats] : {std::pair{"meshes", ResourceManager::mesh_stats()},
+                                          std::pair{"textures", ResourceManager::texture_stats()},
+                                          std::pair{"programs", ResourceManager::program_stats()}})
+            Logger::info(std::string("Resources ") + kind + ": " + std::to_string(stats.live) + " live, "
+                         + std::to_string(stats.hits) + " hits, " + std::to_string(stats.misses) + " misses");
 
         //transparency blending function
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -115,42 +187,88 @@ void App::init_imgui() const {
 }
 
 void App::init_assets() {
-    shader = ShaderProgram("shaders/basic.vert", "shaders/better.frag");
+    m_FrameUniforms = std::make_unique<FrameUniforms>();
+    if (gpu_driven)
+        m_GpuScene = std::make_unique<GpuScene>(shader());
 
     // sizes
-    constexpr float wall_height = 2.0f;
 
     // floor
-    Model floor = Model("assets/objects/cube_triangles_vnt.obj", shader, "assets/textures/ground.png");
+    Model floor = Model("assets/objects/cube_triangles_vnt.obj", shader(), "assets/textures/ground.png");
     floor.transparent = false;
     floor.m_origin = glm::vec3(0.0f, 0.0f, 0.0f);
     floor.scale = glm::vec3(64.0f, 0.1f, 64.0f);
-    this->add_to_scene("floor", &floor);
+    m_Floor = this->add_to_scene("floor", &floor);
 
     // moving teapots with lights
-    Model teapot_model = Model("assets/objects/teapot.obj", shader, "assets/textures/teapot.png");
+    Model teapot_model = Model("assets/objects/teapot.obj", shader(), "assets/textures/teapot.png");
     float scale = .15f;
+    teapot_model.dynamic = true;
     Model tp1(teapot_model);
     tp1.m_origin = glm::vec3(30.0f, 1.0f, 30.0f);
     tp1.scale = glm::vec3(scale);
-    this->add_to_scene("tp1", &tp1);
+    m_Teapots.push_back(this->add_to_scene("tp1", &tp1));
+    m_TeapotLights.push_back(m_Scene.create(Model(), "tp1-light", m_Teapots.back()));
     Model tp2(teapot_model);
     tp2.m_origin = glm::vec3(2.0f, 1.0f, 2.0f);
     tp2.scale = glm::vec3(scale);
-    this->add_to_scene("tp2", &tp2);
+    m_Teapots.push_back(this->add_to_scene("tp2", &tp2));
+    m_TeapotLights.push_back(m_Scene.create(Model(), "tp2-light", m_Teapots.back()));
 
     // sun
-    Model sun = Model("assets/objects/cube_triangles_vnt.obj", shader, "assets/textures/yellow.jpg");
+    Model sun = Model("assets/objects/cube_triangles_vnt.obj", shader(), "assets/textures/yellow.jpg");
     sun.transparent = false;
+    sun.dynamic = true;
     sun.m_origin = glm::vec3(-4.0f, 6.0f, -4.0f);
     sun.scale = glm::vec3(2.0f);
-    this->add_to_scene("sun", &sun);
+    m_Sun = this->add_to_scene("sun", &sun);
 
 
     // walls
-    Model wall_template = Model("assets/objects/cube_triangles_vnt.obj", shader, "assets/textures/wall.png");
-    Model box_template = Model("assets/objects/cube_triangles_vnt.obj", shader, "assets/textures/red.jpg");
+    if (baked_maze) {
+        std::vector<Vertex> maze_vertices;
+        std::vector<GLuint> maze_indices;
+        MazeMeshBuilder maze_builder(wall_height);
+        const TextureResource wall_texture = ResourceManager::load_texture("assets/textures/wall.png");
+        const int chunk = std::max(maze_chunk_size, 1);
+        size_t quads = 0, triangles = 0, chunks = 0;
+
+        // one model per chunk, so walls behind the camera can be culled
+        for (int cy = 0; cy < m_Map->height(); cy += chunk) {
+            for (int cx = 0; cx < m_Map->width(); cx += chunk) {
+                maze_builder.build(*m_Map, cx, cy, cx + chunk, cy + chunk, maze_vertices, maze_indices);
+                if (maze_indices.empty())
+                    continue;
+
+                Model maze;
+                maze.meshes.emplace_back(std::make_shared<Mesh>(
+                    GL_TRIANGLES,
+                    shader(),
+                    maze_vertices,
+                    maze_indices,
+                    glm::vec3(0.0f),
+                    glm::vec3(0.0f),
+                    ResourceManager::texture(wall_texture)
+                ));
+                maze.meshes.back()->texture_resource = ResourceManager::retain(wall_texture);
+                maze.update_bounds();
+                this->add_to_scene("maze-" + std::to_string(cx) + "-" + std::to_string(cy), &maze);
+
+                quads += maze_builder.quad_count();
+                triangles += maze_indices.size() / 3;
+                ++chunks;
+            }
+        }
+
+        ResourceManager::release(wall_texture);
+        Logger::info("Baked maze: " + std::to_string(chunks) + " chunks, " + std::to_string(quads) + " quads, "
+                     + std::to_string(triangles) + " triangles");
+    }
+
+    Model wall_template = Model("assets/objects/cube_triangles_vnt.obj", shader(), "assets/textures/wall.png");
+    Model box_template = Model("assets/objects/cube_triangles_vnt.obj", shader(), "assets/textures/red.jpg");
     box_template.transparent = true;
+    box_template.meshes[0]->diffuse_material.w = 0.5f; // red.jpg has no alpha channel
 
     for (int y = 0; y < m_Map->height(); ++y) {
         for (int x = 0; x < m_Map->width(); ++x) {
@@ -161,13 +279,14 @@ void App::init_assets() {
 
             if (cell == CELL_WALL) {
                 std::cout << "█";
+                if (baked_maze)
+                    continue;
 
                 Model wall = wall_template;
                 wall.m_origin = center + glm::vec3(0.0f, wall_height - 1.5f, 0.0f);
                 wall.scale    = glm::vec3(1.0f, wall_height, 1.0f);
 
-                add_to_scene("wall-" + std::to_string(x) + "-" + std::to_string(y),
-                             &wall);
+                add_instanced(wall);
             } else if (cell == CELL_START || cell == CELL_END) {
                 std::cout << "X";
 
@@ -183,25 +302,187 @@ void App::init_assets() {
         }
         std::cout << '\n';
     }
+
+    // material table before any batching, batches and draw keys depend on Mesh::material_index
+    m_Materials = std::make_unique<MaterialTextures>(texture_binding);
+    {
+        std::vector<Mesh*> meshes;
+        for (std::uint32_t i = 0; i < m_Scene.size(); ++i)
+            for (Mesh* mesh : m_Scene.meshes_of(i))
+                meshes.push_back(mesh);
+        for (const Model* model : {&wall_template, &box_template})
+            for (const auto& mesh : model->meshes)
+                meshes.push_back(mesh.get());
+        m_Materials->build(meshes, shader());
+    }
+
+    // templates not referenced by m_Scene or an instance batch, give their resources back now
+    for (const Model* model : {&wall_template, &box_template})
+        for (const auto& mesh : model->meshes)
+            if (mesh.use_count() == 1)
+                mesh->clear();
+
+    for (auto& batch : m_Batches)
+        batch.upload();
+
+    if (m_GpuScene) {
+        for (std::uint32_t i = 0; i < m_Scene.size(); ++i)
+            if (!m_Scene.is_transparent(i))
+                m_GpuScene->add_entity(m_Scene, i);
+        m_GpuScene->build();
+    }
+
+    // static transparent entities are instanced once and drawn unsorted by the OIT pass
+    if (oit) {
+        m_Oit = std::make_unique<OitPass>();
+        for (std::uint32_t i = 0; i < m_Scene.size(); ++i) {
+            if (!m_Scene.is_transparent(i) || m_Scene.is_dynamic(i))
+                continue;
+            for (Mesh* mesh : m_Scene.meshes_of(i)) {
+                auto it = std::ranges::find_if(m_TransparentBatches, [&](const InstanceBatch& b) { return b.mesh() == mesh; });
+                if (it == m_TransparentBatches.end()) {
+                    // non-owning, the mesh lives in m_Scene
+                    m_TransparentBatches.emplace_back(std::shared_ptr<Mesh>(std::shared_ptr<Mesh>{}, mesh));
+                    it = std::prev(m_TransparentBatches.end());
+                }
+                it->add(m_Scene.world_matrices[i]);
+            }
+        }
+        for (auto& batch : m_TransparentBatches)
+            batch.upload();
+    }
+
+    m_SceneIndex = std::make_unique<SceneIndex>(static_cast<float>(std::max(maze_chunk_size, 1)));
+    if (m_GpuScene) {
+        // opaque entities are culled and drawn by GpuScene, the CPU only queries what it still submits
+        std::vector<std::uint32_t> cpu_drawn;
+        for (std::uint32_t i = 0; i < m_Scene.size(); ++i)
+            if (m_Scene.is_transparent(i) && (!m_Oit || m_Scene.is_dynamic(i)))
+                cpu_drawn.push_back(i);
+        m_SceneIndex->build(m_Scene, cpu_drawn);
+    }
+    else {
+        m_SceneIndex->build(m_Scene);
+    }
+
+    if (maze_pvs) {
+        const auto pvs_start = std::chrono::steady_clock::now();
+        m_Pvs = std::make_unique<MazePvs>();
+        m_Pvs->build(*m_Map);
+        const auto pvs_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - pvs_start).count();
+        Logger::info("Maze PVS: " + std::to_string(m_Pvs->memory_bytes() / 1024) + " KiB, " + std::to_string(pvs_ms) + " ms");
+    }
+
+    if (clustered_lighting) {
+        m_ClusteredLighting = std::make_unique<ClusteredLighting>();
+        shader().setUniform("uClustered"_u, 1);
+        init_torches();
+    }
+}
+
+ShaderProgram::Defines App::light_variant(bool spot, bool sun, int point_lights) const {
+    return {{"SPOT_LIGHT", spot ? 1 : 0}, {"SUN_LIGHT", sun ? 1 : 0}, {"POINT_LIGHTS", point_lights},
+            {"CLUSTERED", m_ClusteredLighting ? 1 : 0}};
+}
+
+std::uint8_t App::select_lod(std::uint32_t id, const glm::vec3& bounds_min, const glm::vec3& bounds_max) {
+    const auto meshes = m_Scene.meshes_of(id);
+    if (meshes.empty() || meshes.front()->lods.size() < 2)
+        return 0;
+
+    // object space error -> world (largest axis scale) -> pixels at the nearest point of the bounding sphere
+    const glm::mat4& m = m_Scene.world_matrices[id];
+    const float scale = std::max({glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))});
+    const float radius = glm::length(bounds_max - bounds_min) * 0.5f;
+    const float distance = std::max(glm::distance(m_Camera->m_position, (bounds_min + bounds_max) * 0.5f) - radius, near_plane);
+    const float pixels_per_unit = static_cast<float>(m_height) / (2.0f * distance * std::tan(glm::radians(m_fov) * 0.5f));
+
+    std::uint8_t& lod = m_Scene.lods[id];
+    lod = static_cast<std::uint8_t>(meshes.front()->select_lod(pixels_per_unit * scale, lod, lod_bias));
+    return lod;
+}
+
+void App::update_pvs() {
+    // PVS only holds for an eye inside the corridors, not above the walls
+    glm::ivec2 cell(static_cast<int>(std::floor(m_Camera->m_position.x)), static_cast<int>(std::floor(m_Camera->m_position.z)));
+    if (m_Camera->m_position.y >= wall_height || !m_Pvs->has_set(cell.x, cell.y))
+        cell = glm::ivec2(-1, -1);
+    if (cell == m_PvsCell)
+        return;
+
+    m_PvsCell = cell;
+    m_PvsHidden.assign(m_Scene.size(), 0);
+    if (cell.x < 0)
+        return;
+
+    for (std::uint32_t i = 0; i < m_Scene.size(); ++i) {
+        if (m_Scene.is_dynamic(i))
+            continue;
+        glm::vec3 min, max;
+        m_Scene.world_bounds(i, min, max);
+        constexpr float eps = 1e-3f;
+        if (max.y > wall_height + eps)
+            continue; // sticks out above the walls (start / end markers), seen from any cell
+        if (!m_Pvs->any_visible(cell.x, cell.y,
+                                static_cast<int>(std::floor(min.x + eps)), static_cast<int>(std::floor(min.z + eps)),
+                                static_cast<int>(std::floor(max.x - eps)), static_cast<int>(std::floor(max.z - eps))))
+            m_PvsHidden[i] = 1;
+    }
+}
+
+void App::init_torches() {
+    // first slots are rewritten by teapot lights every frame
+    auto& lights = m_ClusteredLighting->lights();
+    lights.assign(MAX_TEAPOTS, ClusteredLighting::unused_light());
+
+    std::vector<glm::vec2> empty_cells;
+    for (int y = 0; y < m_Map->height(); ++y)
+        for (int x = 0; x < m_Map->width(); ++x)
+            if (m_Map->at(x, y) != CELL_WALL)
+                empty_cells.emplace_back(x, y);
+
+    std::mt19937 rng(42);
+    std::ranges::shuffle(empty_cells, rng);
+    std::uniform_real_distribution<float> intensity(0.6f, 1.0f);
+
+    const int count = std::min<int>(torch_count, static_cast<int>(empty_cells.size()));
+    for (int i = 0; i < count; ++i) {
+        const glm::vec3 diffuse = glm::vec3(1.0f, 0.6f, 0.25f) * intensity(rng);
+        constexpr float constant = 1.0f, linear = 0.35f, exponent = 0.44f;
+
+        ClusterLight torch{};
+        torch.position_radius = glm::vec4(empty_cells[i].x + 0.5f, 1.5f, empty_cells[i].y + 0.5f,
+                                          ClusteredLighting::light_radius(diffuse, constant, linear, exponent));
+        torch.diffuse = glm::vec4(diffuse, 0.0f);
+        torch.specular = glm::vec4(0.3f);
+        torch.attenuation = glm::vec4(constant, linear, exponent, 0.0f);
+        lights.push_back(torch);
+    }
+    Logger::info("Clustered lighting: " + std::to_string(count) + " torches");
 }
 
 
 int App::run() {
     try {
-        shader.activate();
+        shader().activate();
 
         glfwGetFramebufferSize(window, &m_width, &m_height);
         update_projection_matrix(window);
-        shader.setUniform("uP_m", m_Projection_matrix);
 
         // fps
         double fps_timer = 0.0;
         int fps_counter_frames = 0;
         int fps_display = 0;
 
+        // uniform uploads per frame
+        std::uint64_t uniform_uploads_prev = 0, uniform_skipped_prev = 0;
+        GLState::Stats gl_stats_prev{};
+        std::uint64_t transform_updates_prev = 0;
+
         float lastFrameTime = static_cast<float>(glfwGetTime());
         float speed = 5.0f;
 
+        bool first_frame = true;
         while (!glfwWindowShouldClose(window)) {
             float current_frame_time = static_cast<float>(glfwGetTime());
             float delta_time = current_frame_time - lastFrameTime;
@@ -210,16 +491,24 @@ int App::run() {
             fps_timer += delta_time;
             fps_counter_frames++;
 
+            TextureStreamer::update();
+
+            // saved shaders are rebuilt by the driver in the background, swapped in once linked
+            if (m_ShaderWatcher)
+                for (const auto& file : m_ShaderWatcher->poll())
+                    ResourceManager::reload_programs(file);
+            ResourceManager::update_programs();
+
             if (fps_timer >= 1.0) {
                 fps_display = fps_counter_frames;
                 fps_counter_frames = 0;
                 fps_timer = 0.0;
             }
 
-            shader.setUniform("uP_m", m_Projection_matrix);
-
-            std::vector<std::shared_ptr<Model>> transparent;
-            transparent.reserve(m_Scene.size());
+            // wait until GPU released this frame's uniform slot
+            m_FrameUniforms->begin_frame();
+            FrameConstants& frame = m_FrameUniforms->frame();
+            LightConstants& lights = m_FrameUniforms->lights();
 
             // movement
             glm::vec3 movement = m_Camera->handle_input(window, delta_time * speed);
@@ -248,15 +537,17 @@ int App::run() {
 
 
             //teapots
-            constexpr int MAX_TEAPOTS = 2;
             int teapot_count = 0;
+            std::array<Entity, MAX_TEAPOTS> teapot_anchors{};
+            if (m_ClusteredLighting) // slots of removed teapots stay empty
+                std::fill_n(m_ClusteredLighting->lights().begin(), MAX_TEAPOTS, ClusteredLighting::unused_light());
 
-            for (int i = 1; i <= MAX_TEAPOTS; ++i) {
-                std::string object_name = "tp" + std::to_string(i);
-                if (m_Scene.contains(object_name)) {
-                    auto teapot = find_in_scene(object_name);
+            for (int i = 1; i <= static_cast<int>(m_Teapots.size()); ++i) {
+                const std::uint32_t teapot_id = m_Scene.dense(m_Teapots[i - 1]);
+                if (teapot_id != Entity::INVALID) {
+                    Transform* teapot = &m_Scene.edit_transform(teapot_id);
 
-                    if (teapot && teapot_count < MAX_TEAPOTS) {
+                    if (teapot_count < MAX_TEAPOTS) {
                         // animation
                         float amplitude = 0.5f;
                         float anim_speed = 1.5f;
@@ -269,30 +560,37 @@ int App::run() {
                         glm::vec3 animatedColor = baseColor * colorIntensity;
 
                         // Move the teapot
-                        glm::vec3 moved_origin = teapot->m_origin;
+                        glm::vec3 moved_origin = teapot->origin;
                         moved_origin.y += offset;
 
                         // update model matrix
-                        teapot->local_model_matrix = glm::translate(glm::mat4(1.0f), moved_origin);
-                        teapot->local_model_matrix = glm::scale(teapot->local_model_matrix, teapot->scale);
+                        teapot->local_matrix = glm::translate(glm::mat4(1.0f), moved_origin);
+                        teapot->local_matrix = glm::scale(teapot->local_matrix, teapot->scale);
 
-                        // get position from model matrix
-                        glm::vec3 position = glm::vec3(teapot->local_model_matrix[3]);
-
-                        std::string idx = std::to_string(teapot_count);
+                        // light anchor is a child of the teapot, positioned after update_world below
+                        teapot_anchors[teapot_count] = m_TeapotLights[i - 1];
 
                         // point light properties
-                        shader.setUniform("teapotLight[" + idx + "].position", position);
-                        shader.setUniform("teapotLight[" + idx + "].diffuse", animatedColor);
-                        shader.setUniform("teapotLight[" + idx + "].specular", glm::vec3(1.0f));
-                        shader.setUniform("teapotLight[" + idx + "].constant", 1.0f);
-                        shader.setUniform("teapotLight[" + idx + "].linear", 0.09f);
-                        shader.setUniform("teapotLight[" + idx + "].exponent", 0.032f);
+                        PointLightStd140& light = lights.teapot_light[teapot_count];
+                        light.diffuse = animatedColor;
+                        light.specular = glm::vec3(1.0f);
+                        light.constant = 1.0f;
+                        light.linear = 0.09f;
+                        light.exponent = 0.032f;
 
                         // emissive properties
-                        shader.setUniform("teapotEmissive[" + idx + "].color", animatedColor);
-                        shader.setUniform("teapotEmissive[" + idx + "].position", position);
-                        shader.setUniform("teapotEmissive[" + idx + "].radius", 2.0f);
+                        EmissiveLightStd140& emissive = lights.teapot_emissive[teapot_count];
+                        emissive.color = animatedColor;
+                        emissive.radius = 2.0f;
+
+                        if (m_ClusteredLighting) {
+                            ClusterLight& cluster_light = m_ClusteredLighting->lights()[teapot_count];
+                            cluster_light.position_radius = glm::vec4(glm::vec3(0.0f),
+                                ClusteredLighting::light_radius(animatedColor, light.constant, light.linear, light.exponent));
+                            cluster_light.diffuse = glm::vec4(animatedColor, 0.0f);
+                            cluster_light.specular = glm::vec4(light.specular, 0.0f);
+                            cluster_light.attenuation = glm::vec4(light.constant, light.linear, light.exponent, 0.0f);
+                        }
 
                         teapot_count++;
                     }
@@ -300,8 +598,8 @@ int App::run() {
             }
 
             // set actual number of teapot lights
-            shader.setUniform("teapotCount", teapot_count);
-            shader.setUniform("pointLightOn", 1);
+            lights.teapot_count = teapot_count;
+            lights.point_light_on = 1;
 
             // sun cycle
             float angle = (current_frame_time / 30.0f) * glm::two_pi<float>();
@@ -311,7 +609,20 @@ int App::run() {
                 20.0f * sin(angle),
                 0.f,
             };
-            find_in_scene("sun")->m_origin = sun_pos;
+            m_Scene.edit_transform(m_Scene.dense(m_Sun)).origin = sun_pos;
+
+            // world matrices of animated entities, one hierarchy pass for all of them
+            m_Scene.update_world();
+
+            for (int t = 0; t < teapot_count; ++t) {
+                const glm::vec3 position = glm::vec3(m_Scene.world_matrices[m_Scene.dense(teapot_anchors[t])][3]);
+                lights.teapot_light[t].position = position;
+                lights.teapot_emissive[t].position = position;
+                if (m_ClusteredLighting) {
+                    glm::vec4& position_radius = m_ClusteredLighting->lights()[t].position_radius;
+                    position_radius = glm::vec4(position, position_radius.w);
+                }
+            }
 
             float brightness = glm::clamp((sun_pos.y + 5.0f) / 10.0f, 0.15f, 1.0f);
 
@@ -319,76 +630,152 @@ int App::run() {
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 
-            shader.setUniform("ambient", glm::vec3(0.03f, 0.03f, 0.03f));
+            lights.ambient = glm::vec3(0.03f, 0.03f, 0.03f);
 
-            // Spotlight
-            shader.setUniform("uV_m", m_Camera->get_view_matrix());
-
-            shader.setUniform("viewPos", m_Camera->m_position);
+            // camera
+            frame.view = m_Camera->get_view_matrix();
+            frame.projection = m_Projection_matrix;
+            frame.view_projection = m_Projection_matrix * frame.view;
+            frame.camera_position = glm::vec4(m_Camera->m_position, 1.0f);
+            frame.screen = glm::vec4(m_width, m_height, near_plane, far_plane);
 
-            shader.setUniform("spotLight.diffuse", glm::vec3(0.8f, 0.8f, 0.8f));
-            shader.setUniform("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-            shader.setUniform("spotLight.position", m_Camera->m_position);
-            shader.setUniform("spotLight.direction", m_Camera->m_front);
-            shader.setUniform("spotLight.cosInnerCone", glm::cos(glm::radians(15.0f)));
-            shader.setUniform("spotLight.cosOuterCone", glm::cos(glm::radians(20.0f)));
-            shader.setUniform("spotLight.constant", 1.0f);
-            shader.setUniform("spotLight.linear", 0.07f);
-            shader.setUniform("spotLight.exponent", 0.0017f);
+            // Spotlight
+            SpotLightStd140& spot = lights.spot_light;
+            spot.diffuse = glm::vec3(0.8f, 0.8f, 0.8f);
+            spot.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+            spot.position = m_Camera->m_position;
+            spot.direction = m_Camera->m_front;
+            spot.cos_inner_cone = glm::cos(glm::radians(15.0f));
+            spot.cos_outer_cone = glm::cos(glm::radians(20.0f));
+            spot.constant = 1.0f;
+            spot.linear = 0.07f;
+            spot.exponent = 0.0017f;
+            spot.on = flashlight_on ? 1 : 0;
 
-            shader.setUniform("SpotlightLightOn", flashlight_on? 1:0);
+            lights.spot_light_on = flashlight_on ? 1 : 0;
 
 
             // directional light
-            shader.setUniform("directionalLightOn", 1);
-
-            glm::vec3 sun_position = find_in_scene("sun")->m_origin;
+            glm::vec3 sun_position = m_Scene.transform(m_Scene.dense(m_Sun)).origin;
             glm::vec3 sun_target = glm::vec3(0.0f);
 
             glm::vec3 sun_direction = glm::normalize(sun_target - sun_position);
-            shader.setUniform("directionLight.direction", sun_direction);
+            lights.direction_light.direction = sun_direction;
 
             float sun_intensity = glm::clamp(sun_position.y, 0.0f, 1.0f);
             if (sun_intensity > 0.0f) {
                 glm::vec3 diffuse = glm::vec3(0.8f, 0.8f, 0.6f);
                 glm::vec3 specular = glm::vec3(0.5f);
 
-                shader.setUniform("directionLight.diffuse", diffuse * sun_intensity);
-                shader.setUniform("directionLight.specular", specular * sun_intensity);
-                shader.setUniform("directionalLightOn", 1);
+                lights.direction_light.diffuse = diffuse * sun_intensity;
+                lights.direction_light.specular = specular * sun_intensity;
+                lights.directional_light_on = 1;
             }
             else {
-                shader.setUniform("directionalLightOn", 0);  // turn off
+                lights.directional_light_on = 0;  // turn off
             }
             // sun emission
-            shader.setUniform("sunEmissive.position", sun_position);
-            shader.setUniform("sunEmissive.color", glm::vec3(1.0f, 1.0f, 0.5f));
-            shader.setUniform("sunEmissive.radius", 10.0f);  // adjust for spread
+            lights.sun_emissive.position = sun_position;
+            lights.sun_emissive.color = glm::vec3(1.0f, 1.0f, 0.5f);
+            lights.sun_emissive.radius = 10.0f;  // adjust for spread
+
+            // upload all per-frame constants at once
+            m_FrameUniforms->commit();
+
+            // light switches compiled out, the uber program draws until the variant is built
+            if (shader_variants) {
+                const ShaderProgram::Defines variant = light_variant(flashlight_on, lights.directional_light_on != 0, teapot_count);
+                shader().prewarm(variant);
+                shader().select(shader().ready(variant) ? variant : ShaderProgram::Defines{});
+            }
+            m_Materials->bind();
+
+            if (m_ClusteredLighting)
+                m_ClusteredLighting->update();
+
+            // visible set of m_Scene, walls behind the camera are never submitted
+            // GPU driven: transparent entities only, see init_assets
+            m_SceneIndex->query(m_Scene, Frustum(frame.view_projection), m_Visible);
+            if (m_Pvs) {
+                update_pvs();
+                if (m_PvsCell.x >= 0)
+                    std::erase_if(m_Visible, [&](std::uint32_t id) { return m_PvsHidden[id] != 0; });
+            }
+
+            // build and sort the frame's draw list
+            m_RenderQueue.clear();
+            for (const std::uint32_t id : m_Visible) {
+                const bool transparent = m_Scene.is_transparent(id);
+                if (m_Oit && transparent && !m_Scene.is_dynamic(id))
+                    continue; // in m_TransparentBatches
+
+                glm::vec3 bounds_min, bounds_max;
+                m_Scene.world_bounds(id, bounds_min, bounds_max);
+                // OIT needs no ordering, key sorts transparent draws by state only
+                const float depth = (m_Oit && transparent) ? 0.0f
+                    : glm::distance(m_Camera->m_position, (bounds_min + bounds_max) * 0.5f) / far_plane;
+                const RenderPass pass = transparent ? RenderPass::Transparent : RenderPass::Opaque;
+                const std::uint8_t lod = select_lod(id, bounds_min, bounds_max);
+
+                for (Mesh* mesh : m_Scene.meshes_of(id))
+                    m_RenderQueue.push(pass, mesh, m_Scene.world_matrices[id], m_Scene.normal_matrices[id], depth, m_Scene.tex_scales[id], lod);
+            }
+            m_RenderQueue.sort();
 
             // not transparent objects
-            for (auto& [name, model] : m_Scene) {
-                if (!model->transparent) {
-                    shader.setUniform("tex_scale", (name == "world_floor") ? 20.0f : 1.0f);
-                    model->draw();
-                }
-                else {
-                    transparent.emplace_back(model);
-                }
+            if (m_GpuScene) {
+                shader().setUniform("tex_scale"_u, 1.0f);
+                m_GpuScene->update(m_Scene);
+                m_GpuScene->cull(frame.view_projection);
+                m_GpuScene->draw();
+                m_GpuScene->update_depth_pyramid(m_width, m_height);
+            }
+            else {
+                m_RenderQueue.execute(RenderPass::Opaque);
+
+                // instanced static objects (walls)
+                shader().setUniform("tex_scale"_u, 1.0f);
+                for (auto& batch : m_Batches)
+                    batch.draw();
             }
 
             // transparent objects
-            std::ranges::sort(transparent, [&](const std::shared_ptr<Model> &a, const std::shared_ptr<Model> &b) {
-                auto ta = glm::vec3(a->local_model_matrix[3]);
-                auto tb = glm::vec3(b->local_model_matrix[3]);
-                return glm::distance(m_Camera->m_position, ta) < glm::distance(m_Camera->m_position, tb);
-                });
-
-            glEnable(GL_BLEND);
-            glDepthMask(GL_FALSE);
             glDisable(GL_CULL_FACE);
-            for (auto p : transparent) p->draw();
+            if (m_Oit) {
+                // any order, weighted blended
+                m_Oit->begin(m_width, m_height);
+                shader().setUniform("uOitPass"_u, 1);
+                m_RenderQueue.execute(RenderPass::Transparent);
+                shader().setUniform("tex_scale"_u, 1.0f);
+                for (auto& batch : m_TransparentBatches)
+                    batch.draw();
+                shader().setUniform("uOitPass"_u, 0);
+                m_Oit->end();
+                m_Oit->composite();
+            }
+            else {
+                // back to front
+                glEnable(GL_BLEND);
+                glDepthMask(GL_FALSE);
+                m_RenderQueue.execute(RenderPass::Transparent);
+            }
             glDisable(GL_BLEND);
             glDepthMask(GL_TRUE);
+            glEnable(GL_CULL_FACE);
+
+            const std::uint64_t frame_uploads = shader().uniform_uploads() - uniform_uploads_prev;
+            const std::uint64_t frame_skipped = shader().uniform_skipped() - uniform_skipped_prev;
+            uniform_uploads_prev = shader().uniform_uploads();
+            uniform_skipped_prev = shader().uniform_skipped();
+
+            const GLState::Stats& gl_stats = GLState::stats();
+            const std::uint64_t frame_program_skipped = gl_stats.program_skipped - gl_stats_prev.program_skipped;
+            const std::uint64_t frame_texture_skipped = gl_stats.texture_skipped - gl_stats_prev.texture_skipped;
+            const std::uint64_t frame_vao_skipped = gl_stats.vertex_array_skipped - gl_stats_prev.vertex_array_skipped;
+            gl_stats_prev = gl_stats;
+
+            const std::uint64_t frame_transform_updates = m_Scene.transform_updates() - transform_updates_prev;
+            transform_updates_prev = m_Scene.transform_updates();
 
             // IMGUI
             if (show_imgui) {
@@ -407,14 +794,49 @@ int App::run() {
                 ImGui::Text("Antialiasing:     %s", antialiasing_enabled ? "ON" : "OFF");
                 ImGui::Text("Multisample:      %s", glIsEnabled(GL_MULTISAMPLE) ? "YES" : "NO");
                 ImGui::Text("FOV:              %.1f", m_fov);
+                ImGui::Text("GPU driven:       %s", m_GpuScene ? "ON" : "OFF");
+                ImGui::Text("Visible objects:  %d / %d", static_cast<int>(m_Visible.size()), static_cast<int>(m_SceneIndex->size()));
+                ImGui::Text("Transforms:       %llu updated", static_cast<unsigned long long>(frame_transform_updates));
+                if (m_Pvs)
+                    ImGui::Text("PVS cells:        %d (%s)", static_cast<int>(m_Pvs->visible_count(m_PvsCell.x, m_PvsCell.y)),
+                                m_PvsCell.x < 0 ? "off" : "on");
+                ImGui::Text("Point lights:     %d%s", m_ClusteredLighting ? static_cast<int>(m_ClusteredLighting->lights().size()) - MAX_TEAPOTS + teapot_count : teapot_count,
+                            m_ClusteredLighting ? " (clustered)" : "");
+                ImGui::Text("Shader variants:  %zu", shader().variant_count());
+                ImGui::Text("Uniforms:         %llu sent, %llu skipped",
+                            static_cast<unsigned long long>(frame_uploads), static_cast<unsigned long long>(frame_skipped));
+                ImGui::Text("Binds skipped:    %llu program, %llu texture, %llu VAO",
+                            static_cast<unsigned long long>(frame_program_skipped), static_cast<unsigned long long>(frame_texture_skipped),
+                            static_cast<unsigned long long>(frame_vao_skipped));
+                const ResourceManager::Stats& mesh_res = ResourceManager::mesh_stats();
+                const ResourceManager::Stats& texture_res = ResourceManager::texture_stats();
+                const ResourceManager::Stats& program_res = ResourceManager::program_stats();
+                ImGui::Text("Resources:        %u live, %llu hits, %llu misses",
+                            mesh_res.live + texture_res.live + program_res.live,
+                            static_cast<unsigned long long>(mesh_res.hits + texture_res.hits + program_res.hits),
+                            static_cast<unsigned long long>(mesh_res.misses + texture_res.misses + program_res.misses));
+                ImGui::Text("Mesh memory:      %.1f KiB (%s)", static_cast<double>(m_Scene.mesh_bytes()) / 1024.0,
+                            Mesh::packed_formats ? "packed" : "float");
+                ImGui::Text("Textures pending: %zu", TextureStreamer::pending());
+                ImGui::Text("Materials:        %zu (%s)", m_Materials->size(),
+                            m_Materials->mode() == TextureBinding::Bindless ? "bindless"
+                            : m_Materials->mode() == TextureBinding::Array ? "array" : "separate");
                 ImGui::End();
 
                 ImGui::Render();
                 ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                GLState::invalidate(); // ImGui binds its own program, VAO and font texture
             }
 
 
+            m_FrameUniforms->end_frame();
+
             glfwSwapBuffers(window);
+            if (first_frame) {
+                first_frame = false;
+                Logger::info("Time to first frame: " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - m_StartTime).count()) + " ms");
+            }
             glfwPollEvents();
         }
     }
@@ -438,23 +860,58 @@ void App::update_projection_matrix(GLFWwindow* window) {
     instance->m_Projection_matrix = glm::perspective(
         glm::radians(instance->m_fov),   // The vertical Field of View, in radians: the amount of "zoom". Think "camera lens". Usually between 90° (extra wide) and 30° (quite zoomed in)
         ratio,               // Aspect Ratio. Depends on the size of your window.
-        0.1f,                // Near clipping plane. Keep as big as possible, or you'll get precision issues.
-        100.0f             // 20000.0f Far clipping plane. Keep as little as possible.
+        near_plane,          // Near clipping plane. Keep as big as possible, or you'll get precision issues.
+        far_plane            // 20000.0f Far clipping plane. Keep as little as possible.
     );
 }
 
-void App::add_to_scene(const std::string& name, Model* model) {
+Entity App::add_to_scene(const std::string& name, Model* model) {
     if (model == nullptr) {
         Logger::error("Attempting to add a null model to the scene.");
+        return {};
+    }
+
+    return m_Scene.create(*model, name);
+}
+
+void App::add_instanced(const Model& model) {
+    if (m_GpuScene) {
+        m_GpuScene->add_model(model);
         return;
     }
 
-    m_Scene[name] = std::make_shared<Model>(*model);
+    const glm::mat4 model_matrix = model.get_model_matrix();
+
+    for (const auto& mesh : model.meshes) {
+        auto it = std::ranges::find_if(m_Batches, [&](const InstanceBatch& b) { return b.mesh() == mesh.get(); });
+        if (it == m_Batches.end()) {
+            m_Batches.emplace_back(mesh);
+            it = std::prev(m_Batches.end());
+        }
+        it->add(model_matrix);
+    }
 }
 
 
 App::~App() {
-    shader.clear();
+    if (m_GpuScene)
+        m_GpuScene->clear();
+    for (auto& batch : m_Batches)
+        batch.clear();
+    if (m_FrameUniforms)
+        m_FrameUniforms->clear();
+    if (m_ClusteredLighting)
+        m_ClusteredLighting->clear();
+    for (auto& batch : m_TransparentBatches)
+        batch.clear();
+    if (m_Oit)
+        m_Oit->clear();
+    if (m_Materials)
+        m_Materials->clear();
+    TextureStreamer::clear();
+    m_Scene.clear();
+    ResourceManager::release(m_Program);
+    ResourceManager::clear();
     if (window)
         glfwDestroyWindow(window);
 
@@ -512,6 +969,29 @@ void App::load_config() {
         fullscreen = config.value("fullscreen", false);
         free_cam = config.value("free_cam", false);
         flashlight_on = config.value("flashlight", false);
+        baked_maze = config.value("baked_maze", true);
+        gpu_driven = config.value("gpu_driven", false);
+        clustered_lighting = config.value("clustered_lighting", true);
+        torch_count = config.value("torch_count", 256);
+        maze_chunk_size = config.value("maze_chunk_size", 4);
+        maze_pvs = config.value("maze_pvs", true);
+        oit = config.value("oit", true);
+        lod_bias = config.value("lod_bias", 1.0f);
+        Mesh::packed_formats = config.value("packed_vertices", true);
+        MeshCache::enabled = config.value("mesh_cache", true);
+        ShaderProgram::binary_cache = config.value("shader_binary_cache", true);
+        ShaderProgram::spirv = config.value("shader_spirv", false);
+        shader_hot_reload = config.value("shader_hot_reload", true);
+        shader_variants = config.value("shader_variants", true);
+        texture_streaming = config.value("texture_streaming", true);
+        texture_upload_budget_kb = config.value("texture_upload_budget_kb", 2048);
+        const std::string compression = config.value("texture_compression", std::string("bc"));
+        TextureBaker::compress = compression != "none";
+        TextureBaker::bc7 = compression == "bc7";
+        const std::string binding = config.value("texture_binding", std::string("array"));
+        texture_binding = binding == "separate" ? TextureBinding::Separate
+                        : binding == "bindless" ? TextureBinding::Bindless
+                        : TextureBinding::Array;
         win_width = config.value("window_width", 800);
         win_height = config.value("window_height", 600);
     }
@@ -548,11 +1028,6 @@ void App::toggle_fullscreen() {
     Logger::error("WINDOW: " + std::string(fullscreen ? "FULLSCREEN" : "WINDOWED"));
 }
 
-std::shared_ptr<Model> App::find_in_scene(const std::string& name)  {
-    auto it = m_Scene.find(name);
-    if (it != m_Scene.end()) {
-        return it->second;
-    }
-    Logger::error("Model not found: " + name);
-    return {};
-};
+Entity App::find_in_scene(const std::string& name) const {
+    return m_Scene.find(name);
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include <random>
 #include <unordered_map>
 #include <filesystem>
@@ -13,6 +14,19 @@
 #include "Camera.hpp"
 #include "ShaderProgram.hpp"
 #include "Model.hpp"
+#include "InstanceBatch.hpp"
+#include "GpuScene.hpp"
+#include "FrameUniforms.hpp"
+#include "ClusteredLighting.hpp"
+#include "Scene.hpp"
+#include "SceneIndex.hpp"
+#include "MazePvs.hpp"
+#include "RenderQueue.hpp"
+#include "ResourceManager.hpp"
+#include "GLState.hpp"
+#include "OitPass.hpp"
+#include "MaterialTextures.hpp"
+#include "ShaderWatcher.hpp"
 #include "Collision.hpp"
 #include "Logger.hpp"
 #include "Map.hpp"
@@ -29,7 +43,8 @@ public:
     static void print_gl_info();
 
     static void update_projection_matrix(GLFWwindow* window);
-    void add_to_scene(const std::string& name, Model* model);
+    Entity add_to_scene(const std::string& name, Model* model); // copies the model into the entity store
+    void add_instanced(const Model& model); // static model drawn through shared instance batch
 
     bool is_jumping = false;
     float jump_velocity = 0.0f;
@@ -57,11 +72,31 @@ private:
     bool show_imgui = false;
     bool flashlight_on = false;
     bool free_cam = false; // fly mode
+    bool baked_maze = true; // walls baked into one static mesh instead of instanced cubes
+    bool gpu_driven = false; // GPU culling + multi draw indirect for opaque objects
+    bool clustered_lighting = true; // clustered forward shading, allows many point lights
+    int torch_count = 256; // point lights placed in maze corridors (clustered mode only)
+    int maze_chunk_size = 4; // baked maze is split into chunks of NxN cells for culling
+    bool maze_pvs = true; // skip models outside the potentially visible set of the camera cell
+    bool oit = true; // weighted blended order independent transparency instead of sorting
+    float lod_bias = 1.0f; // allowed LOD error in pixels, 0 = always full detail
+    TextureBinding texture_binding = TextureBinding::Array; // how material textures reach the shader
+    bool texture_streaming = true; // decode textures on worker threads, upload over several frames
+    int texture_upload_budget_kb = 2048; // streamed texture data uploaded per frame
+    bool shader_hot_reload = true; // rebuild programs whose files in shaders/ were saved
+    bool shader_variants = true; // better.frag specialized for the light state instead of runtime branches
 
     GLFWwindow* window = nullptr;
-    ShaderProgram shader;
+    std::chrono::steady_clock::time_point m_StartTime; // init() entry, for the time to first frame
+    ProgramResource m_Program; // basic.vert + better.frag
+    ShaderProgram& shader() const { return ResourceManager::program(m_Program); }
 
+    void init_context(); // window, GL context and global GL state
     void init_assets();
+    void init_torches();
+    void update_pvs();
+    std::uint8_t select_lod(std::uint32_t id, const glm::vec3& bounds_min, const glm::vec3& bounds_max);
+    ShaderProgram::Defines light_variant(bool spot, bool sun, int point_lights) const;
     void init_imgui() const;
 
     static void error_callback(int error, const char* description);
@@ -75,15 +110,35 @@ private:
     void toggle_fullscreen();
 
 protected:
-    std::shared_ptr<Model> find_in_scene(const std::string& name);
+    Entity find_in_scene(const std::string& name) const; // setup only, keep the handle
 
     // projection
     int m_width{ 0 }, m_height{ 0 };
     float m_fov = 60.0f;
+    static constexpr float near_plane = 0.1f;
+    static constexpr float far_plane = 100.0f;
+    static constexpr float wall_height = 2.0f;
     glm::mat4 m_Projection_matrix = glm::identity<glm::mat4>();
 
     // scene
-    std::unordered_map<std::string, std::shared_ptr<Model>> m_Scene;
+    Scene m_Scene;
+    Entity m_Floor, m_Sun;
+    std::vector<Entity> m_Teapots;
+    std::vector<Entity> m_TeapotLights; // children of m_Teapots, light position follows the teapot
+    std::vector<InstanceBatch> m_Batches; // static models grouped by shared mesh
+    std::vector<InstanceBatch> m_TransparentBatches; // static transparent entities, OIT mode only
+    std::unique_ptr<OitPass> m_Oit;
+    std::unique_ptr<MaterialTextures> m_Materials; // texture array / bindless table, all meshes of the scene
+    RenderQueue m_RenderQueue; // visible models, rebuilt and sorted every frame
+    std::unique_ptr<SceneIndex> m_SceneIndex; // frustum culling of m_Scene
+    std::vector<std::uint32_t> m_Visible; // dense scene ids
+    std::unique_ptr<MazePvs> m_Pvs;
+    glm::ivec2 m_PvsCell{-1, -1};                // camera cell the hidden set was built for
+    std::vector<std::uint8_t> m_PvsHidden;     // per dense id, static entities outside of the PVS
+    std::unique_ptr<GpuScene> m_GpuScene; // only in gpu_driven mode
+    std::unique_ptr<FrameUniforms> m_FrameUniforms; // camera + lights, shared by all programs
+    std::unique_ptr<ClusteredLighting> m_ClusteredLighting; // only in clustered_lighting mode
+    std::unique_ptr<ShaderWatcher> m_ShaderWatcher; // only with shader_hot_reload
     std::shared_ptr<Map> m_Map;
 
 };
@@ -3,8 +3,8 @@
 // Copyright (c) 2025 FM TUL. All rights reserved.
 //
 
-#ifndef TEXTURE_HPP
-#define TEXTURE_HPP
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
 
 #include <string>
 #include <vector>
@@ -40,4 +40,4 @@ private:
     void updateCameraVectors();
 };
 
-#endif //TEXTURE_HPP
\ No newline at end of file
+#endif //CAMERA_HPP
\ No newline at end of file
@@ -0,0 +1,65 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 26.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include "ClusteredLighting.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Logger.hpp"
+
+ClusteredLighting::ClusteredLighting()
+    : m_assign_program(ResourceManager::load_program("shaders/cluster_lights.comp")) {
+    glCreateBuffers(1, &m_light_buffer);
+    glNamedBufferStorage(m_light_buffer, MAX_LIGHTS * sizeof(ClusterLight), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    // per cluster light count
+    glCreateBuffers(1, &m_grid_buffer);
+    glNamedBufferStorage(m_grid_buffer, CLUSTER_COUNT * sizeof(GLuint), nullptr, 0);
+
+    // fixed size light index list per cluster
+    glCreateBuffers(1, &m_index_buffer);
+    glNamedBufferStorage(m_index_buffer, static_cast<GLsizeiptr>(CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER * sizeof(GLuint),
+                         nullptr, 0);
+}
+
+float ClusteredLighting::light_radius(const glm::vec3& diffuse, float constant, float linear, float exponent) {
+    // 1 / (c + l*d + q*d^2) * max_color = 5/256  ->  q*d^2 + l*d + c - max_color*256/5 = 0
+    const float max_color = std::max({diffuse.x, diffuse.y, diffuse.z});
+    const float c = constant - max_color * 256.0f / 5.0f;
+    if (exponent <= 0.0f)
+        return linear > 0.0f ? std::max(0.0f, -c / linear) : 100.0f;
+    return (-linear + std::sqrt(std::max(0.0f, linear * linear - 4.0f * exponent * c))) / (2.0f * exponent);
+}
+
+void ClusteredLighting::update() {
+    if (m_lights.size() > MAX_LIGHTS) {
+        Logger::warning("Clustered lighting: too many lights, " + std::to_string(m_lights.size() - MAX_LIGHTS) + " dropped");
+        m_lights.resize(MAX_LIGHTS);
+    }
+    if (!m_lights.empty())
+        glNamedBufferSubData(m_light_buffer, 0, static_cast<GLsizeiptr>(m_lights.size() * sizeof(ClusterLight)), m_lights.data());
+
+    ShaderProgram& program = ResourceManager::program(m_assign_program);
+    program.activate();
+    program.setUniform("uLightCount"_u, static_cast<int>(m_lights.size()));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_BINDING, m_light_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GRID_BINDING, m_grid_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDEX_BINDING, m_index_buffer);
+
+    // one work group per depth slice, one invocation per tile
+    glDispatchCompute(1, 1, CLUSTER_Z);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void ClusteredLighting::clear() {
+    const GLuint buffers[] = {m_light_buffer, m_grid_buffer, m_index_buffer};
+    glDeleteBuffers(static_cast<GLsizei>(std::size(buffers)), buffers);
+    m_light_buffer = m_grid_buffer = m_index_buffer = 0;
+    ResourceManager::release(m_assign_program);
+    m_assign_program = {};
+    m_lights.clear();
+}
@@ -0,0 +1,68 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 26.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef CLUSTEREDLIGHTING_HPP
+#define CLUSTEREDLIGHTING_HPP
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "ResourceManager.hpp"
+
+// clustered forward shading
+// - view frustum split into CLUSTER_X * CLUSTER_Y screen tiles and CLUSTER_Z exponential depth slices
+// - cluster_lights.comp assigns point lights to clusters every frame
+// - better.frag reads only the light list of its own cluster
+// grid sizes must match #defines in cluster_lights.comp and better.frag
+
+// layout matches ClusterLight (std430)
+struct ClusterLight {
+    glm::vec4 position_radius;  // xyz world position, w = range where light is cut off
+    glm::vec4 diffuse;          // rgb
+    glm::vec4 specular;         // rgb
+    glm::vec4 attenuation;      // constant, linear, exponent
+};
+
+class ClusteredLighting {
+public:
+    static constexpr int CLUSTER_X = 16;
+    static constexpr int CLUSTER_Y = 9;
+    static constexpr int CLUSTER_Z = 24;
+    static constexpr int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+    static constexpr int MAX_LIGHTS_PER_CLUSTER = 128;
+    static constexpr int MAX_LIGHTS = 1024;
+
+    // SSBO binding points used by cluster_lights.comp and better.frag
+    static constexpr GLuint LIGHT_BINDING = 5;
+    static constexpr GLuint GRID_BINDING = 6;
+    static constexpr GLuint INDEX_BINDING = 7;
+
+    ClusteredLighting();
+
+    // light list, App rewrites dynamic entries every frame
+    std::vector<ClusterLight>& lights() noexcept { return m_lights; }
+
+    // slot without a light this frame, negative radius is skipped by cluster_lights.comp
+    static ClusterLight unused_light() {
+        return {glm::vec4(0.0f, 0.0f, 0.0f, -1.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(1.0f, 0.0f, 0.0f, 0.0f)};
+    }
+
+    // range where attenuated light drops under visible threshold
+    static float light_radius(const glm::vec3& diffuse, float constant, float linear, float exponent);
+
+    // upload lights and build cluster light lists, FrameBlock must be bound already
+    void update();
+
+    void clear(); // deallocate GL objects - dont put in destructor
+
+private:
+    ProgramResource m_assign_program;
+    std::vector<ClusterLight> m_lights;
+
+    GLuint m_light_buffer{0}, m_grid_buffer{0}, m_index_buffer{0};
+};
+
+#endif //CLUSTEREDLIGHTING_HPP
@@ -0,0 +1,72 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 24.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include "FrameUniforms.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+GLsizeiptr align_up(GLsizeiptr value, GLsizeiptr alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+}
+
+FrameUniforms::FrameUniforms() {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    m_frame_offset = 0;
+    m_light_offset = align_up(sizeof(FrameConstants), alignment);
+    m_slot_size = align_up(m_light_offset + static_cast<GLsizeiptr>(sizeof(LightConstants)), alignment);
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &m_buffer);
+    glNamedBufferStorage(m_buffer, m_slot_size * FRAMES, nullptr, flags);
+    m_mapped = static_cast<std::byte*>(glMapNamedBufferRange(m_buffer, 0, m_slot_size * FRAMES, flags));
+    if (m_mapped == nullptr)
+        throw std::runtime_error("Cannot map frame uniform buffer");
+}
+
+void FrameUniforms::begin_frame() {
+    GLsync& fence = m_fences[m_slot];
+    if (fence == nullptr)
+        return;
+
+    // usually already signaled, GPU is at most FRAMES-1 frames behind
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED)
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000); // 1 ms
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void FrameUniforms::commit() {
+    const GLsizeiptr slot_offset = m_slot * m_slot_size;
+    std::memcpy(m_mapped + slot_offset + m_frame_offset, &m_frame, sizeof(FrameConstants));
+    std::memcpy(m_mapped + slot_offset + m_light_offset, &m_lights, sizeof(LightConstants));
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BINDING, m_buffer, slot_offset + m_frame_offset, sizeof(FrameConstants));
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHT_BINDING, m_buffer, slot_offset + m_light_offset, sizeof(LightConstants));
+}
+
+void FrameUniforms::end_frame() {
+    m_fences[m_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_slot = (m_slot + 1) % FRAMES;
+}
+
+void FrameUniforms::clear() {
+    for (auto& fence : m_fences) {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_buffer) {
+        glUnmapNamedBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+    }
+    m_buffer = 0;
+    m_mapped = nullptr;
+}
@@ -0,0 +1,120 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 24.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef FRAMEUNIFORMS_HPP
+#define FRAMEUNIFORMS_HPP
+
+#include <array>
+#include <cstddef>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// std140 mirrors of uniform blocks in basic.vert / better.frag
+// vec3 is 16 byte aligned in std140, padding is explicit
+
+constexpr int MAX_POINT_LIGHTS = 4; // MAX_TEAPOTS in better.frag
+
+struct FrameConstants {          // FrameBlock, binding 0
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_projection;   // precomputed on CPU
+    glm::vec4 camera_position;
+    glm::vec4 screen;            // width, height, near, far
+};
+
+struct PointLightStd140 {
+    glm::vec3 position;  float pad0;
+    glm::vec3 diffuse;   float pad1;
+    glm::vec3 specular;
+    float constant;
+    float linear;
+    float exponent;
+    float pad2[2];
+};
+
+struct SpotLightStd140 {
+    glm::vec3 position;  float pad0;
+    glm::vec3 direction;
+    float cos_inner_cone;
+    float cos_outer_cone;
+    float pad1[3];
+    glm::vec3 diffuse;   float pad2;
+    glm::vec3 specular;
+    int on;
+    float constant;
+    float linear;
+    float exponent;
+    float pad3;
+};
+
+struct DirectionalLightStd140 {
+    glm::vec3 direction; float pad0;
+    glm::vec3 diffuse;   float pad1;
+    glm::vec3 specular;  float pad2;
+};
+
+struct EmissiveLightStd140 {
+    glm::vec3 color;     float pad0;
+    glm::vec3 position;
+    float radius;
+};
+
+struct LightConstants {          // LightBlock, binding 1
+    PointLightStd140 teapot_light[MAX_POINT_LIGHTS];
+    EmissiveLightStd140 teapot_emissive[MAX_POINT_LIGHTS];
+    SpotLightStd140 spot_light;
+    DirectionalLightStd140 direction_light;
+    EmissiveLightStd140 sun_emissive;
+    glm::vec3 ambient;
+    int teapot_count;
+    int spot_light_on;
+    int point_light_on;
+    int directional_light_on;
+    int pad0;
+};
+
+static_assert(sizeof(PointLightStd140) == 64);
+static_assert(sizeof(SpotLightStd140) == 96);
+static_assert(sizeof(DirectionalLightStd140) == 48);
+static_assert(sizeof(EmissiveLightStd140) == 32);
+static_assert(offsetof(LightConstants, spot_light) == 384);
+static_assert(offsetof(LightConstants, ambient) == 560);
+static_assert(offsetof(LightConstants, directional_light_on) == 584);
+
+// per-frame constants in one persistently mapped buffer
+// triple buffered ring, every slot is guarded by a fence so the CPU never overwrites data the GPU still reads
+class FrameUniforms {
+public:
+    static constexpr int FRAMES = 3;
+    static constexpr GLuint FRAME_BINDING = 0;
+    static constexpr GLuint LIGHT_BINDING = 1;
+
+    FrameUniforms();
+
+    // CPU copies, filled by App every frame
+    FrameConstants& frame() noexcept { return m_frame; }
+    LightConstants& lights() noexcept { return m_lights; }
+
+    void begin_frame(); // wait until current slot is free
+    void commit();      // copy structs to mapped slot and bind it
+    void end_frame();   // fence current slot, advance ring
+
+    void clear(); // deallocate GL buffer - dont put in destructor
+
+private:
+    FrameConstants m_frame{};
+    LightConstants m_lights{};
+
+    GLuint m_buffer{0};
+    std::byte* m_mapped = nullptr;
+    GLsizeiptr m_frame_offset = 0; // inside slot
+    GLsizeiptr m_light_offset = 0;
+    GLsizeiptr m_slot_size = 0;
+
+    std::array<GLsync, FRAMES> m_fences{};
+    int m_slot = 0;
+};
+
+#endif //FRAMEUNIFORMS_HPP
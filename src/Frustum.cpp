@@ -0,0 +1,121 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 23.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#include "Frustum.hpp"
+
+void AabbList::push(const glm::vec3& min, const glm::vec3& max) {
+    center_x.push_back(0.0f); center_y.push_back(0.0f); center_z.push_back(0.0f);
+    extent_x.push_back(0.0f); extent_y.push_back(0.0f); extent_z.push_back(0.0f);
+    set(size() - 1, min, max);
+}
+
+void AabbList::set(size_t index, const glm::vec3& min, const glm::vec3& max) {
+    const glm::vec3 center = (min + max) * 0.5f;
+    const glm::vec3 extent = (max - min) * 0.5f;
+    center_x[index] = center.x; center_y[index] = center.y; center_z[index] = center.z;
+    extent_x[index] = extent.x; extent_y[index] = extent.y; extent_z[index] = extent.z;
+}
+
+void AabbList::clear() {
+    center_x.clear(); center_y.clear(); center_z.clear();
+    extent_x.clear(); extent_y.clear(); extent_z.clear();
+}
+
+Frustum::Frustum(const glm::mat4& view_projection)
+    : m_planes(extract_planes(view_projection)) {}
+
+std::array<glm::vec4, 6> Frustum::extract_planes(const glm::mat4& m) {
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    std::array<glm::vec4, 6> planes = {
+        row3 + row0, row3 - row0,
+        row3 + row1, row3 - row1,
+        row3 + row2, row3 - row2,
+    };
+    for (auto& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+    return planes;
+}
+
+bool Frustum::intersects(const glm::vec3& min, const glm::vec3& max) const {
+    const glm::vec3 center = (min + max) * 0.5f;
+    const glm::vec3 extent = (max - min) * 0.5f;
+    for (const auto& plane : m_planes) {
+        // box is outside when even its most positive corner is behind the plane
+        const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        const float radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+        if (distance + radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+void Frustum::test(const AabbList& boxes, size_t first, size_t count, std::uint8_t* out) const {
+    size_t i = 0;
+
+#ifdef FRUSTUM_SSE
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4) {
+        const size_t b = first + i;
+        const __m128 cx = _mm_loadu_ps(&boxes.center_x[b]);
+        const __m128 cy = _mm_loadu_ps(&boxes.center_y[b]);
+        const __m128 cz = _mm_loadu_ps(&boxes.center_z[b]);
+        const __m128 ex = _mm_loadu_ps(&boxes.extent_x[b]);
+        const __m128 ey = _mm_loadu_ps(&boxes.extent_y[b]);
+        const __m128 ez = _mm_loadu_ps(&boxes.extent_z[b]);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero); // all bits set
+        for (const auto& plane : m_planes) {
+            const __m128 px = _mm_set1_ps(plane.x);
+            const __m128 py = _mm_set1_ps(plane.y);
+            const __m128 pz = _mm_set1_ps(plane.z);
+
+            __m128 distance = _mm_add_ps(_mm_mul_ps(px, cx), _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(py, cy));
+            distance = _mm_add_ps(distance, _mm_mul_ps(pz, cz));
+
+            __m128 radius = _mm_mul_ps(_mm_andnot_ps(sign_mask, px), ex);
+            radius = _mm_add_ps(radius, _mm_mul_ps(_mm_andnot_ps(sign_mask, py), ey));
+            radius = _mm_add_ps(radius, _mm_mul_ps(_mm_andnot_ps(sign_mask, pz), ez));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        out[i + 0] = (mask >> 0) & 1;
+        out[i + 1] = (mask >> 1) & 1;
+        out[i + 2] = (mask >> 2) & 1;
+        out[i + 3] = (mask >> 3) & 1;
+    }
+#endif
+
+    // scalar tail (or everything without SSE)
+    for (; i < count; ++i) {
+        const size_t b = first + i;
+        bool inside = true;
+        for (const auto& plane : m_planes) {
+            const float distance = plane.x * boxes.center_x[b] + plane.y * boxes.center_y[b] + plane.z * boxes.center_z[b] + plane.w;
+            const float radius = std::abs(plane.x) * boxes.extent_x[b] + std::abs(plane.y) * boxes.extent_y[b]
+                               + std::abs(plane.z) * boxes.extent_z[b];
+            if (distance + radius < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+        out[i] = inside ? 1 : 0;
+    }
+}
@@ -0,0 +1,45 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 23.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// axis aligned boxes stored as structure of arrays (center + half extent),
+// lets the frustum test load four boxes into one SSE register per component
+struct AabbList {
+    std::vector<float> center_x, center_y, center_z;
+    std::vector<float> extent_x, extent_y, extent_z;
+
+    void push(const glm::vec3& min, const glm::vec3& max);
+    void set(size_t index, const glm::vec3& min, const glm::vec3& max);
+    void clear();
+    size_t size() const noexcept { return center_x.size(); }
+};
+
+class Frustum {
+public:
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& view_projection);
+
+    // Gribb & Hartmann, normalized planes pointing inside the frustum
+    static std::array<glm::vec4, 6> extract_planes(const glm::mat4& view_projection);
+
+    const std::array<glm::vec4, 6>& planes() const noexcept { return m_planes; }
+
+    bool intersects(const glm::vec3& min, const glm::vec3& max) const;
+
+    // tests boxes [first, first + count), out[i] = 1 when box first + i is (partially) inside
+    void test(const AabbList& boxes, size_t first, size_t count, std::uint8_t* out) const;
+
+private:
+    std::array<glm::vec4, 6> m_planes{};
+};
+
+#endif //FRUSTUM_HPP
@@ -0,0 +1,52 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 25.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include "GLState.hpp"
+
+GLuint GLState::s_program = GLState::UNKNOWN;
+GLuint GLState::s_vertex_array = GLState::UNKNOWN;
+std::array<GLuint, GLState::MAX_TEXTURE_UNITS> GLState::s_textures = [] {
+    std::array<GLuint, MAX_TEXTURE_UNITS> textures{};
+    textures.fill(UNKNOWN);
+    return textures;
+}();
+GLState::Stats GLState::s_stats{};
+
+void GLState::use_program(GLuint program) {
+    if (s_program == program) {
+        ++s_stats.program_skipped;
+        return;
+    }
+    glUseProgram(program);
+    s_program = program;
+    ++s_stats.program_binds;
+}
+
+void GLState::bind_vertex_array(GLuint vao) {
+    if (s_vertex_array == vao) {
+        ++s_stats.vertex_array_skipped;
+        return;
+    }
+    glBindVertexArray(vao);
+    s_vertex_array = vao;
+    ++s_stats.vertex_array_binds;
+}
+
+void GLState::bind_texture(GLuint unit, GLuint texture) {
+    if (unit < MAX_TEXTURE_UNITS && s_textures[unit] == texture) {
+        ++s_stats.texture_skipped;
+        return;
+    }
+    glBindTextureUnit(unit, texture);
+    if (unit < MAX_TEXTURE_UNITS)
+        s_textures[unit] = texture;
+    ++s_stats.texture_binds;
+}
+
+void GLState::invalidate() {
+    s_program = UNKNOWN;
+    s_vertex_array = UNKNOWN;
+    s_textures.fill(UNKNOWN);
+}
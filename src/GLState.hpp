@@ -0,0 +1,46 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 25.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef GLSTATE_HPP
+#define GLSTATE_HPP
+
+#include <array>
+#include <cstdint>
+#include <GL/glew.h>
+
+// shadow of the bound program, vertex array and 2D textures
+// - redundant binds are dropped before they reach the driver
+// - every bind of these objects must go through here, otherwise call invalidate()
+class GLState {
+public:
+    static constexpr int MAX_TEXTURE_UNITS = 16;
+
+    struct Stats {
+        std::uint64_t program_binds = 0;
+        std::uint64_t program_skipped = 0;
+        std::uint64_t texture_binds = 0;
+        std::uint64_t texture_skipped = 0;
+        std::uint64_t vertex_array_binds = 0;
+        std::uint64_t vertex_array_skipped = 0;
+    };
+
+    static void use_program(GLuint program);
+    static void bind_vertex_array(GLuint vao);
+    static void bind_texture(GLuint unit, GLuint texture); // DSA, target comes from the texture
+
+    static void invalidate(); // forget everything, e.g. after external GL code (ImGui)
+
+    static const Stats& stats() noexcept { return s_stats; }
+
+private:
+    static constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    static GLuint s_program;
+    static GLuint s_vertex_array;
+    static std::array<GLuint, MAX_TEXTURE_UNITS> s_textures;
+    static Stats s_stats;
+};
+
+#endif //GLSTATE_HPP
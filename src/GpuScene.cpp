@@ -0,0 +1,353 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 22.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include "GpuScene.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Frustum.hpp"
+#include "GLState.hpp"
+#include "Logger.hpp"
+
+GpuScene::GpuScene(ShaderProgram& shader)
+    : m_shader(shader),
+      m_cull_program(ResourceManager::load_program("shaders/cull.comp")),
+      m_depth_reduce_program(ResourceManager::load_program("shaders/depth_reduce.comp")) {}
+
+void GpuScene::add_model(const Model& model) {
+    const glm::mat4 model_matrix = model.get_model_matrix();
+    const glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3(model_matrix)));
+    for (const auto& mesh : model.meshes) {
+        if (std::ranges::find(m_model_meshes, mesh) == m_model_meshes.end())
+            m_model_meshes.push_back(mesh);
+        add_object(*mesh, model_matrix, normal_matrix);
+    }
+}
+
+void GpuScene::add_entity(const Scene& scene, uint32_t dense) {
+    const uint32_t source = scene.is_dynamic(dense) ? dense : Entity::INVALID;
+    for (Mesh* mesh : scene.meshes_of(dense))
+        add_object(*mesh, scene.world_matrices[dense], scene.normal_matrices[dense], source);
+}
+
+uint32_t GpuScene::add_mesh(const Mesh& mesh) {
+    auto it = m_mesh_lookup.find(&mesh);
+    if (it != m_mesh_lookup.end())
+        return it->second;
+
+    MeshRange range{};
+    range.first_index = static_cast<GLuint>(m_indices.size());
+    range.index_count = static_cast<GLuint>(mesh.indices.size());
+    range.base_vertex = static_cast<GLint>(m_vertices.size());
+    range.bounds_min = mesh.bounds_min;
+    range.bounds_max = mesh.bounds_max;
+
+    m_vertices.insert(m_vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+    m_indices.insert(m_indices.end(), mesh.indices.begin(), mesh.indices.end());
+
+    const auto index = static_cast<uint32_t>(m_meshes.size());
+    m_meshes.push_back(range);
+    m_mesh_lookup[&mesh] = index;
+    return index;
+}
+
+void GpuScene::add_object(Mesh& mesh, const glm::mat4& model_matrix, const glm::mat3& normal_matrix, uint32_t entity) {
+    Object object{};
+    object.source = &mesh;
+    object.mesh = add_mesh(mesh);
+    object.model_matrix = model_matrix;
+    object.normal_matrix = normal_matrix;
+    object.entity = entity;
+    m_objects.push_back(std::move(object));
+}
+
+InstanceData GpuScene::make_instance(const Object& object) const {
+    InstanceData instance{};
+    instance.model_matrix = object.model_matrix;
+    instance.normal_matrix = glm::mat4(object.normal_matrix);
+    instance.normal_matrix[3][0] = static_cast<float>(object.source->material_index + 1);
+    return instance;
+}
+
+GpuScene::ObjectCull GpuScene::make_cull(const Object& object) const {
+    const MeshRange& mesh = m_meshes[object.mesh];
+
+    // world space AABB of transformed local bounds
+    glm::vec3 world_min(std::numeric_limits<float>::max());
+    glm::vec3 world_max(std::numeric_limits<float>::lowest());
+    for (int i = 0; i < 8; ++i) {
+        const glm::vec3 corner((i & 1) ? mesh.bounds_max.x : mesh.bounds_min.x,
+                               (i & 2) ? mesh.bounds_max.y : mesh.bounds_min.y,
+                               (i & 4) ? mesh.bounds_max.z : mesh.bounds_min.z);
+        const glm::vec3 world = glm::vec3(object.model_matrix * glm::vec4(corner, 1.0f));
+        world_min = glm::min(world_min, world);
+        world_max = glm::max(world_max, world);
+    }
+
+    ObjectCull cull{};
+    cull.aabb_min = glm::vec4(world_min, 1.0f);
+    cull.aabb_max = glm::vec4(world_max, 1.0f);
+    cull.index_count = mesh.index_count;
+    cull.first_index = mesh.first_index;
+    cull.base_vertex = mesh.base_vertex;
+    cull.batch = object.batch;
+    return cull;
+}
+
+void GpuScene::build() {
+    // one batch per bound texture, material table meshes need none (MaterialTextures assigns indices before build)
+    m_batches.clear();
+    for (auto& object : m_objects) {
+        const GLuint texture = object.source->bound_texture();
+        const bool table = object.source->material_index >= 0;
+        auto batch = std::ranges::find_if(m_batches, [&](const Batch& b) {
+            return (b.material->material_index >= 0) == table && b.material->bound_texture() == texture;
+        });
+        if (batch == m_batches.end()) {
+            m_batches.push_back({object.source});
+            batch = std::prev(m_batches.end());
+        }
+        object.batch = static_cast<uint32_t>(std::distance(m_batches.begin(), batch));
+    }
+
+    // objects of one batch must be contiguous, object index == draw index == instance index
+    std::ranges::stable_sort(m_objects, {}, &Object::batch);
+
+    m_dynamic.clear();
+    for (auto& batch : m_batches)
+        batch.object_count = 0;
+    for (size_t i = 0; i < m_objects.size(); ++i) {
+        Batch& batch = m_batches[m_objects[i].batch];
+        if (batch.object_count++ == 0)
+            batch.first_object = static_cast<GLuint>(i);
+        if (m_objects[i].entity != Entity::INVALID)
+            m_dynamic.push_back(i);
+    }
+
+    // shared geometry
+    glCreateBuffers(1, &m_vbo);
+    glNamedBufferStorage(m_vbo, static_cast<GLsizeiptr>(m_vertices.size() * sizeof(Vertex)), m_vertices.data(), 0);
+    glCreateBuffers(1, &m_ebo);
+    glNamedBufferStorage(m_ebo, static_cast<GLsizeiptr>(m_indices.size() * sizeof(GLuint)), m_indices.data(), 0);
+
+    glCreateVertexArrays(1, &m_vao);
+    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(Vertex));
+    glVertexArrayElementBuffer(m_vao, m_ebo);
+
+    glEnableVertexArrayAttrib(m_vao, 0);
+    glVertexArrayAttribFormat(m_vao, 0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_position));
+    glVertexArrayAttribBinding(m_vao, 0, 0);
+    glEnableVertexArrayAttrib(m_vao, 1);
+    glVertexArrayAttribFormat(m_vao, 1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_normal));
+    glVertexArrayAttribBinding(m_vao, 1, 0);
+    glEnableVertexArrayAttrib(m_vao, 2);
+    glVertexArrayAttribFormat(m_vao, 2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_tex_coords));
+    glVertexArrayAttribBinding(m_vao, 2, 0);
+
+    // per object data
+    std::vector<InstanceData> instances;
+    std::vector<ObjectCull> culls;
+    instances.reserve(m_objects.size());
+    culls.reserve(m_objects.size());
+    for (const auto& object : m_objects) {
+        instances.push_back(make_instance(object));
+        culls.push_back(make_cull(object));
+    }
+
+    glCreateBuffers(1, &m_instance_buffer);
+    glNamedBufferStorage(m_instance_buffer, static_cast<GLsizeiptr>(instances.size() * sizeof(InstanceData)),
+                         instances.data(), GL_DYNAMIC_STORAGE_BIT);
+    glCreateBuffers(1, &m_cull_buffer);
+    glNamedBufferStorage(m_cull_buffer, static_cast<GLsizeiptr>(culls.size() * sizeof(ObjectCull)),
+                         culls.data(), GL_DYNAMIC_STORAGE_BIT);
+
+    // one command slot per object, written by cull.comp
+    glCreateBuffers(1, &m_command_buffer);
+    glNamedBufferStorage(m_command_buffer, static_cast<GLsizeiptr>(m_objects.size() * sizeof(DrawElementsIndirectCommand)),
+                         nullptr, 0);
+
+    std::vector<GLuint> batch_offsets;
+    for (const auto& batch : m_batches)
+        batch_offsets.push_back(batch.first_object);
+    glCreateBuffers(1, &m_batch_buffer);
+    glNamedBufferStorage(m_batch_buffer, static_cast<GLsizeiptr>(batch_offsets.size() * sizeof(GLuint)),
+                         batch_offsets.data(), 0);
+    glCreateBuffers(1, &m_count_buffer);
+    glNamedBufferStorage(m_count_buffer, static_cast<GLsizeiptr>(m_batches.size() * sizeof(GLuint)),
+                         nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    Logger::info("GPU scene: " + std::to_string(m_objects.size()) + " objects, "
+                 + std::to_string(m_meshes.size()) + " meshes, "
+                 + std::to_string(m_batches.size()) + " batches");
+
+    // CPU copies are not needed anymore
+    m_vertices = {};
+    m_indices = {};
+}
+
+void GpuScene::update(const Scene& scene) {
+    for (const size_t i : m_dynamic) {
+        Object& object = m_objects[i];
+        object.model_matrix = scene.world_matrices[object.entity];
+        object.normal_matrix = scene.normal_matrices[object.entity];
+
+        const InstanceData instance = make_instance(object);
+        const ObjectCull cull = make_cull(object);
+        glNamedBufferSubData(m_instance_buffer, static_cast<GLintptr>(i * sizeof(InstanceData)), sizeof(InstanceData), &instance);
+        glNamedBufferSubData(m_cull_buffer, static_cast<GLintptr>(i * sizeof(ObjectCull)), sizeof(ObjectCull), &cull);
+    }
+}
+
+void GpuScene::cull(const glm::mat4& view_projection) {
+    if (m_objects.empty())
+        return;
+    m_view_projection = view_projection;
+
+    const GLuint zero = 0;
+    glClearNamedBufferData(m_count_buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    ShaderProgram& cull = ResourceManager::program(m_cull_program);
+    cull.activate();
+    const auto planes = Frustum::extract_planes(view_projection);
+    for (size_t i = 0; i < planes.size(); ++i)
+        cull.setUniform(UniformId::indexed("uFrustumPlanes", static_cast<unsigned>(i)), planes[i]);
+    cull.setUniform("uObjectCount"_u, static_cast<int>(m_objects.size()));
+
+    // occlusion against previous frame depth, objects hidden there pop in one frame late
+    cull.setUniform("uOcclusion"_u, m_pyramid_valid ? 1 : 0);
+    if (m_pyramid_valid) {
+        cull.setUniform("uPrevViewProj"_u, m_pyramid_view_projection);
+        cull.setUniform("uPyramidSize"_u, glm::vec2(m_pyramid_width, m_pyramid_height));
+        cull.setUniform("uPyramidLevels"_u, m_pyramid_levels);
+        cull.setUniform("uDepthPyramid"_u, 0);
+        GLState::bind_texture(0, m_pyramid);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_cull_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_command_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_count_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_batch_buffer);
+
+    glDispatchCompute(static_cast<GLuint>((m_objects.size() + 63) / 64), 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuScene::draw() {
+    if (m_objects.empty())
+        return;
+
+    m_shader.activate();
+    m_shader.setUniform("uInstanced"_u, 1);
+    // shared buffers hold float vertices
+    m_shader.setUniform("uPosScale"_u, glm::vec3(1.0f));
+    m_shader.setUniform("uPosOffset"_u, glm::vec3(0.0f));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, InstanceBatch::BINDING, m_instance_buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_command_buffer);
+    glBindBuffer(GL_PARAMETER_BUFFER, m_count_buffer);
+    GLState::bind_vertex_array(m_vao);
+
+    for (size_t b = 0; b < m_batches.size(); ++b) {
+        const Batch& batch = m_batches[b];
+        batch.material->bind_material();
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                         reinterpret_cast<const void*>(batch.first_object * sizeof(DrawElementsIndirectCommand)),
+                                         static_cast<GLintptr>(b * sizeof(GLuint)),
+                                         static_cast<GLsizei>(batch.object_count), 0);
+    }
+
+    glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuScene::update_depth_pyramid(int width, int height) {
+    if (width < 2 || height < 2)
+        return;
+
+    // (re)create depth copy and pyramid on resize
+    if (width != m_depth_width || height != m_depth_height) {
+        if (m_depth_fbo) glDeleteFramebuffers(1, &m_depth_fbo);
+        if (m_depth_texture) glDeleteTextures(1, &m_depth_texture);
+        if (m_pyramid) glDeleteTextures(1, &m_pyramid);
+        GLState::invalidate();
+
+        m_depth_width = width;
+        m_depth_height = height;
+
+        // must match default framebuffer depth format for blit
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_depth_texture);
+        glTextureStorage2D(m_depth_texture, 1, GL_DEPTH24_STENCIL8, width, height);
+        glTextureParameteri(m_depth_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(m_depth_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glCreateFramebuffers(1, &m_depth_fbo);
+        glNamedFramebufferTexture(m_depth_fbo, GL_DEPTH_STENCIL_ATTACHMENT, m_depth_texture, 0);
+
+        m_pyramid_width = std::max(1, width / 2);
+        m_pyramid_height = std::max(1, height / 2);
+        m_pyramid_levels = 1 + static_cast<int>(std::floor(std::log2(std::max(m_pyramid_width, m_pyramid_height))));
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_pyramid);
+        glTextureStorage2D(m_pyramid, m_pyramid_levels, GL_R32F, m_pyramid_width, m_pyramid_height);
+        glTextureParameteri(m_pyramid, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTextureParameteri(m_pyramid, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(m_pyramid, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_pyramid, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        m_pyramid_valid = false;
+    }
+
+    glBlitNamedFramebuffer(0, m_depth_fbo, 0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    // max reduction, level 0 from depth copy, every next level from previous one
+    ShaderProgram& reduce = ResourceManager::program(m_depth_reduce_program);
+    reduce.activate();
+    reduce.setUniform("uSrc"_u, 0);
+    int level_width = m_pyramid_width;
+    int level_height = m_pyramid_height;
+    for (int level = 0; level < m_pyramid_levels; ++level) {
+        if (level == 0) {
+            GLState::bind_texture(0, m_depth_texture);
+            reduce.setUniform("uSrcLevel"_u, 0);
+        } else {
+            GLState::bind_texture(0, m_pyramid);
+            reduce.setUniform("uSrcLevel"_u, level - 1);
+        }
+        glBindImageTexture(0, m_pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute(static_cast<GLuint>((level_width + 7) / 8), static_cast<GLuint>((level_height + 7) / 8), 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+        level_width = std::max(1, level_width / 2);
+        level_height = std::max(1, level_height / 2);
+    }
+
+    m_pyramid_view_projection = m_view_projection;
+    m_pyramid_valid = true;
+}
+
+void GpuScene::clear() {
+    const GLuint buffers[] = {m_vbo, m_ebo, m_instance_buffer, m_cull_buffer, m_command_buffer, m_count_buffer, m_batch_buffer};
+    glDeleteBuffers(static_cast<GLsizei>(std::size(buffers)), buffers);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteFramebuffers(1, &m_depth_fbo);
+    glDeleteTextures(1, &m_depth_texture);
+    glDeleteTextures(1, &m_pyramid);
+
+    m_vao = m_vbo = m_ebo = 0;
+    m_instance_buffer = m_cull_buffer = m_command_buffer = m_count_buffer = m_batch_buffer = 0;
+    m_depth_fbo = m_depth_texture = m_pyramid = 0;
+    m_pyramid_valid = false;
+
+    ResourceManager::release(m_cull_program);
+    ResourceManager::release(m_depth_reduce_program);
+    m_cull_program = m_depth_reduce_program = {};
+    m_objects.clear();
+    m_dynamic.clear();
+    m_batches.clear();
+    // last owner deallocates the mesh (instanced walls only live here)
+    for (const auto& mesh : m_model_meshes)
+        if (mesh.use_count() == 1)
+            mesh->clear();
+    m_model_meshes.clear();
+}
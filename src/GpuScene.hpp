@@ -0,0 +1,126 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 22.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef GPUSCENE_HPP
+#define GPUSCENE_HPP
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+#include "Model.hpp"
+#include "Scene.hpp"
+#include "ResourceManager.hpp"
+#include "ShaderProgram.hpp"
+#include "InstanceBatch.hpp"
+
+// GPU driven rendering
+// - all meshes live in shared vertex/index buffers
+// - compute shader culls objects against frustum and previous frame depth pyramid (Hi-Z)
+//   and writes DrawElementsIndirectCommand array + draw count
+// - one glMultiDrawElementsIndirectCount per texture batch submits the frame,
+//   meshes from the MaterialTextures table share a single batch
+class GpuScene {
+public:
+    explicit GpuScene(ShaderProgram& shader);
+
+    void add_model(const Model& model);                        // static, matrix is baked once
+    void add_entity(const Scene& scene, uint32_t dense);      // dynamic entities are refreshed every frame
+
+    // create GL buffers, call after all models are added
+    void build();
+
+    void update(const Scene& scene);                 // refresh dynamic objects
+    void cull(const glm::mat4& view_projection);     // GPU culling, fills indirect buffer
+    void draw();
+    void update_depth_pyramid(int width, int height); // call after opaque pass, used by next frame
+
+    size_t object_count() const noexcept { return m_objects.size(); }
+
+    void clear(); // deallocate GL objects - dont put in destructor
+
+private:
+    // mesh range inside shared buffers
+    struct MeshRange {
+        GLuint first_index;
+        GLuint index_count;
+        GLint base_vertex;
+        glm::vec3 bounds_min;
+        glm::vec3 bounds_max;
+    };
+
+    struct Object {
+        Mesh* source;
+        uint32_t mesh;
+        uint32_t batch;                // assigned in build()
+        glm::mat4 model_matrix;
+        glm::mat3 normal_matrix;       // Scene::normal_matrices, or computed once per model
+        uint32_t entity;               // dense scene id, dynamic objects only
+    };
+
+    // layout matches ObjectBuffer (std430) in cull.comp
+    struct ObjectCull {
+        glm::vec4 aabb_min;
+        glm::vec4 aabb_max;
+        GLuint index_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint batch;
+    };
+
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+
+    // objects sharing one texture
+    struct Batch {
+        Mesh* material; // any mesh of the batch, provides texture and material uniforms
+        GLuint first_object = 0;
+        GLuint object_count = 0;
+    };
+
+    uint32_t add_mesh(const Mesh& mesh);
+    void add_object(Mesh& mesh, const glm::mat4& model_matrix, const glm::mat3& normal_matrix, uint32_t entity = Entity::INVALID);
+    InstanceData make_instance(const Object& object) const;
+    ObjectCull make_cull(const Object& object) const;
+
+    ShaderProgram& m_shader;
+    ProgramResource m_cull_program;
+    ProgramResource m_depth_reduce_program;
+
+    // CPU side
+    std::vector<Vertex> m_vertices;
+    std::vector<GLuint> m_indices;
+    std::vector<MeshRange> m_meshes;
+    std::unordered_map<const Mesh*, uint32_t> m_mesh_lookup;
+    std::vector<Object> m_objects;
+    std::vector<Batch> m_batches;
+    std::vector<size_t> m_dynamic; // indices into m_objects
+    std::vector<std::shared_ptr<Mesh>> m_model_meshes; // add_model() sources, batches keep pointers to them
+
+    // shared geometry
+    GLuint m_vao{0}, m_vbo{0}, m_ebo{0};
+
+    // object, command and count buffers
+    GLuint m_instance_buffer{0}, m_cull_buffer{0}, m_command_buffer{0}, m_count_buffer{0}, m_batch_buffer{0};
+
+    // Hi-Z
+    GLuint m_depth_fbo{0}, m_depth_texture{0}, m_pyramid{0};
+    int m_depth_width{0}, m_depth_height{0};
+    int m_pyramid_width{0}, m_pyramid_height{0}, m_pyramid_levels{0};
+    bool m_pyramid_valid = false;
+    glm::mat4 m_view_projection{1.0f};          // this frame
+    glm::mat4 m_pyramid_view_projection{1.0f};  // frame the pyramid was built from
+};
+
+#endif //GPUSCENE_HPP
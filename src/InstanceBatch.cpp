@@ -0,0 +1,43 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 20.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include "InstanceBatch.hpp"
+
+InstanceBatch::InstanceBatch(std::shared_ptr<Mesh> mesh)
+    : m_mesh(std::move(mesh)) {}
+
+void InstanceBatch::add(const glm::mat4& model_matrix) {
+    InstanceData instance{};
+    instance.model_matrix = model_matrix;
+    instance.normal_matrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model_matrix))));
+    m_instances.push_back(instance);
+}
+
+void InstanceBatch::upload() {
+    if (m_ssbo != 0)
+        glDeleteBuffers(1, &m_ssbo);
+
+    glCreateBuffers(1, &m_ssbo);
+    glNamedBufferStorage(m_ssbo, static_cast<GLsizeiptr>(m_instances.size() * sizeof(InstanceData)),
+                         m_instances.data(), 0);
+}
+
+void InstanceBatch::draw() {
+    if (m_ssbo == 0 || m_instances.empty())
+        return;
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING, m_ssbo);
+    m_mesh->draw_instanced(static_cast<GLsizei>(m_instances.size()));
+}
+
+void InstanceBatch::clear() {
+    if (m_ssbo != 0)
+        glDeleteBuffers(1, &m_ssbo);
+    m_ssbo = 0;
+    m_instances.clear();
+    // last owner deallocates the mesh, non-owning batches (empty owner) never do
+    if (m_mesh.use_count() == 1)
+        m_mesh->clear();
+}
@@ -0,0 +1,46 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 20.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef INSTANCEBATCH_HPP
+#define INSTANCEBATCH_HPP
+
+#include <memory>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+
+// per-instance data, layout matches InstanceBuffer (std430) in basic.vert
+struct InstanceData {
+    glm::mat4 model_matrix;
+    glm::mat4 normal_matrix; // mat3 padded to mat4 for std430, [3].x = material index + 1 (0 = uMaterial)
+};
+
+// all instances of one mesh drawn with a single glDrawElementsInstanced call
+class InstanceBatch {
+public:
+    explicit InstanceBatch(std::shared_ptr<Mesh> mesh);
+
+    void add(const glm::mat4& model_matrix);
+
+    // copy instance data to GPU, call after all instances are added
+    void upload();
+    void draw();
+
+    const Mesh* mesh() const noexcept { return m_mesh.get(); }
+    size_t size() const noexcept { return m_instances.size(); }
+
+    void clear(); // deallocate GL buffer, and the mesh if this is its last owner - dont put in destructor
+
+    static constexpr GLuint BINDING = 0; // SSBO binding point of InstanceBuffer
+
+private:
+    std::shared_ptr<Mesh> m_mesh;
+    std::vector<InstanceData> m_instances;
+    GLuint m_ssbo{0};
+};
+
+#endif //INSTANCEBATCH_HPP
@@ -0,0 +1,142 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 3.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "JobGraph.hpp"
+#include "Logger.hpp"
+
+JobGraph::JobId JobGraph::add(std::string phase, std::string name, Thread thread, std::function<void()> work, std::vector<JobId> dependencies) {
+    const auto id = static_cast<JobId>(m_jobs.size());
+    Job job{std::move(phase), std::move(name), thread, std::move(work)};
+    for (const JobId dependency : dependencies) {
+        if (dependency >= id)
+            throw std::logic_error("JobGraph: dependency added after its dependent");
+        m_jobs[dependency].dependents.push_back(id);
+        ++job.remaining;
+    }
+    m_jobs.push_back(std::move(job));
+    return id;
+}
+
+void JobGraph::run(unsigned workers) {
+    if (workers == 0)
+        workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const auto now_ms = [&] { return std::chrono::duration<double, std::milli>(clock::now() - start).count(); };
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<JobId> ready[2]; // per Thread
+    size_t finished = 0;
+    std::exception_ptr error;
+
+    for (JobId id = 0; id < m_jobs.size(); ++id)
+        if (m_jobs[id].remaining == 0)
+            ready[static_cast<int>(m_jobs[id].thread)].push_back(id);
+
+    // pops and executes one job of the given kind, lock held on entry and exit
+    const auto execute = [&](std::unique_lock<std::mutex>& lock, Thread thread) {
+        auto& queue = ready[static_cast<int>(thread)];
+        const JobId id = queue.front();
+        queue.pop_front();
+        Job& job = m_jobs[id];
+
+        if (!job.skipped) {
+            lock.unlock();
+            job.start_ms = now_ms();
+            std::exception_ptr failure;
+            try {
+                job.work();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            job.end_ms = now_ms();
+            lock.lock();
+            if (failure) {
+                job.skipped = true; // dependents inherit it
+                if (!error)
+                    error = failure;
+            }
+        }
+
+        for (const JobId dependent : job.dependents) {
+            Job& next = m_jobs[dependent];
+            next.skipped = next.skipped || job.skipped;
+            if (--next.remaining == 0)
+                ready[static_cast<int>(next.thread)].push_back(dependent);
+        }
+        ++finished;
+        changed.notify_all();
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < workers; ++i)
+        pool.emplace_back([&] {
+            std::unique_lock lock(mutex);
+            for (;;) {
+                changed.wait(lock, [&] { return finished == m_jobs.size() || !ready[0].empty(); });
+                if (ready[0].empty())
+                    return;
+                execute(lock, Thread::Worker);
+            }
+        });
+
+    {
+        std::unique_lock lock(mutex);
+        for (;;) {
+            changed.wait(lock, [&] { return finished == m_jobs.size() || !ready[1].empty(); });
+            if (ready[1].empty())
+                break;
+            execute(lock, Thread::Main);
+        }
+    }
+    for (auto& thread : pool)
+        thread.join();
+
+    m_total_ms = now_ms();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void JobGraph::log_timings() const {
+    struct Phase {
+        double first = 0.0, last = 0.0, busy = 0.0;
+        size_t jobs = 0;
+    };
+    std::map<std::string, Phase> phases;
+    for (const Job& job : m_jobs) {
+        if (job.skipped)
+            continue;
+        Phase& phase = phases[job.phase];
+        phase.first = phase.jobs == 0 ? job.start_ms : std::min(phase.first, job.start_ms);
+        phase.last = std::max(phase.last, job.end_ms);
+        phase.busy += job.end_ms - job.start_ms;
+        ++phase.jobs;
+    }
+
+    // started first on top
+    std::vector<std::pair<std::string, Phase>> sorted(phases.begin(), phases.end());
+    std::ranges::sort(sorted, {}, [](const auto& p) { return p.second.first; });
+    char line[160];
+    for (const auto& [name, phase] : sorted) {
+        std::snprintf(line, sizeof(line), "Startup %-10s %7.1f .. %7.1f ms (%zu jobs, %.1f ms busy)",
+                      name.c_str(), phase.first, phase.last, phase.jobs, phase.busy);
+        Logger::info(line);
+    }
+    std::snprintf(line, sizeof(line), "Startup total %.1f ms", m_total_ms);
+    Logger::info(line);
+}
@@ -0,0 +1,50 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 3.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef JOBGRAPH_HPP
+#define JOBGRAPH_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// one shot dependency graph of jobs (startup)
+// - Worker jobs run on a thread pool, Main jobs on the thread calling run() - the one owning the GL context
+// - a job starts once all its dependencies finished, a failed job skips its dependents
+// - run() rethrows the first exception after the graph drained
+class JobGraph {
+public:
+    using JobId = std::uint32_t;
+
+    enum class Thread : std::uint8_t {
+        Worker = 0, // CPU only, must not touch GL
+        Main = 1,   // GL, or anything else bound to the calling thread
+    };
+
+    // phase - group in the timing report, e.g. "meshes"
+    JobId add(std::string phase, std::string name, Thread thread, std::function<void()> work, std::vector<JobId> dependencies = {});
+
+    void run(unsigned workers = 0); // 0 = hardware threads - 1
+
+    // wall time per phase (first start to last end) and the summed job time, the critical path shows as overlap
+    void log_timings() const;
+
+private:
+    struct Job {
+        std::string phase, name;
+        Thread thread;
+        std::function<void()> work;
+        std::vector<JobId> dependents;
+        std::uint32_t remaining = 0; // unfinished dependencies
+        bool skipped = false;
+        double start_ms = 0.0, end_ms = 0.0; // since run()
+    };
+
+    std::vector<Job> m_jobs;
+    double m_total_ms = 0.0;
+};
+
+#endif //JOBGRAPH_HPP
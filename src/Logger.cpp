@@ -6,6 +6,7 @@
 #include "Logger.hpp"
 
 #include <iostream>
+#include <mutex>
 #include <ostream>
 
 void Logger::error(const std::string &message) {
@@ -45,5 +46,7 @@ void Logger::log(const LogLevel &level, const std::string &message) {
             colorCode = "\033[34m"; // Blue
             break;
     }
+    static std::mutex mutex; // texture workers log too
+    std::lock_guard lock(mutex);
     std::cout << colorCode << prefix << message << "\033[0m\n"; // Reset color
 }
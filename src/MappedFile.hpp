@@ -0,0 +1,35 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 4.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// read only memory mapping of a whole file (mmap / MapViewOfFile), the OS pages it in on demand
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path); // throws std::runtime_error
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const noexcept { return m_data; }
+    size_t size() const noexcept { return m_size; }
+    std::string_view view() const noexcept { return {m_data, m_size}; }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+#endif //MAPPEDFILE_HPP
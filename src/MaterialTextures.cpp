@@ -0,0 +1,126 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 31.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <bit>
+
+#include "MaterialTextures.hpp"
+#include "GLState.hpp"
+#include "Logger.hpp"
+#include "TextureBaker.hpp"
+#include "TextureStreamer.hpp"
+
+namespace {
+    template <typename T>
+    int index_of(std::vector<T>& items, const T& item) {
+        auto it = std::ranges::find(items, item);
+        if (it == items.end())
+            it = items.insert(items.end(), item);
+        return static_cast<int>(std::distance(items.begin(), it));
+    }
+}
+
+MaterialTextures::MaterialTextures(TextureBinding mode)
+    : m_mode(resolve(mode)) {}
+
+TextureBinding MaterialTextures::resolve(TextureBinding mode) {
+    if (mode == TextureBinding::Bindless && !GLEW_ARB_bindless_texture) {
+        Logger::warning("ARB_bindless_texture not supported, using texture array");
+        return TextureBinding::Array;
+    }
+    return mode;
+}
+
+void MaterialTextures::build(const std::vector<Mesh*>& meshes, ShaderProgram& shader) {
+    if (m_mode == TextureBinding::Separate)
+        return; // meshes keep material_index -1 and bind tex0
+
+    // bindless handles freeze the texture, it needs every level
+    if (m_mode == TextureBinding::Bindless)
+        TextureStreamer::flush();
+
+    for (Mesh* mesh : meshes) {
+        // an array layer is baked from the file of the texture resource, which may have no 2D texture
+        if (m_mode == TextureBinding::Array) {
+            if (ResourceManager::alive(mesh->texture_resource))
+                mesh->material_index = index_of(m_sources, mesh->texture_resource);
+        } else if (mesh->texture_id != 0) {
+            mesh->material_index = index_of(m_textures, mesh->texture_id);
+        }
+    }
+    m_size = m_mode == TextureBinding::Array ? m_sources.size() : m_textures.size();
+    if (m_size == 0)
+        return;
+
+    if (m_mode == TextureBinding::Bindless)
+        build_bindless();
+    else
+        build_array(meshes);
+
+    shader.setUniform("uTexArray"_u, static_cast<int>(UNIT));
+    shader.setUniform("uTextureMode"_u, static_cast<int>(m_mode));
+    Logger::info("Material textures: " + std::to_string(m_size)
+                 + (m_mode == TextureBinding::Bindless ? " bindless handles" : " array layers"));
+}
+
+void MaterialTextures::build_array(const std::vector<Mesh*>& meshes) {
+    const TextureBaker::Format format = TextureBaker::layer_format();
+    const auto levels = static_cast<GLsizei>(std::bit_width(LAYER_SIZE));
+    const auto layers = static_cast<std::uint32_t>(m_sources.size());
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_array);
+    glTextureStorage3D(m_array, levels, TextureBaker::internal_format(format), LAYER_SIZE, LAYER_SIZE, static_cast<GLsizei>(layers));
+    glTextureParameteri(m_array, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_array, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(m_array, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(m_array, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    // layers are baked from the source files (or taken from the prefetch), textures are not read back
+    for (std::uint32_t layer = 0; layer < layers; ++layer)
+        ResourceManager::load_texture_layer(m_sources[layer], m_array, layer, layers, LAYER_SIZE);
+    m_sources.clear();
+
+    for (Mesh* mesh : meshes) {
+        if (mesh->material_index < 0 || !ResourceManager::alive(mesh->texture_resource))
+            continue;
+        // the last mesh gives the source resource back, streaming of a 2D texture is cancelled
+        ResourceManager::release(mesh->texture_resource);
+        mesh->texture_resource = {};
+        mesh->texture_id = 0;
+    }
+}
+
+void MaterialTextures::build_bindless() {
+    // handles freeze the sampler state of the source textures
+    for (const GLuint texture : m_textures) {
+        const GLuint64 handle = glGetTextureHandleARB(texture);
+        glMakeTextureHandleResidentARB(handle);
+        m_handles.push_back(handle);
+    }
+    glCreateBuffers(1, &m_handle_buffer);
+    glNamedBufferStorage(m_handle_buffer, static_cast<GLsizeiptr>(m_handles.size() * sizeof(GLuint64)), m_handles.data(), 0);
+}
+
+void MaterialTextures::bind() const {
+    if (m_array)
+        GLState::bind_texture(UNIT, m_array);
+    if (m_handle_buffer)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HANDLE_BINDING, m_handle_buffer);
+}
+
+void MaterialTextures::clear() {
+    for (const GLuint64 handle : m_handles)
+        glMakeTextureHandleNonResidentARB(handle);
+    m_handles.clear();
+    if (m_handle_buffer) glDeleteBuffers(1, &m_handle_buffer);
+    if (m_array) {
+        TextureStreamer::cancel(m_array);
+        glDeleteTextures(1, &m_array);
+    }
+    m_handle_buffer = m_array = 0;
+    m_textures.clear();
+    m_sources.clear();
+    m_size = 0;
+    GLState::invalidate();
+}
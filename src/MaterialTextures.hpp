@@ -0,0 +1,63 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 31.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MATERIALTEXTURES_HPP
+#define MATERIALTEXTURES_HPP
+
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Mesh.hpp"
+#include "ResourceManager.hpp"
+#include "ShaderProgram.hpp"
+
+enum class TextureBinding : std::uint8_t {
+    Separate = 0, // one GL_TEXTURE_2D bound per draw (tex0)
+    Array = 1,    // all material textures in one GL_TEXTURE_2D_ARRAY, layer = material index
+    Bindless = 2, // ARB_bindless_texture handles in an SSBO, indexed by material index
+};
+
+// material table shared by all draws, meshes only carry a material index (Mesh::material_index)
+// - draws with different textures no longer differ in bound state, so RenderQueue and GpuScene batch them
+// - array layers are baked from the source files at LAYER_SIZE in TextureBaker::layer_format() (BCn, linear
+//   space mips) and streamed into the array, the per-material resources are released
+// - with ResourceManager::texture_layer_size = LAYER_SIZE the resources are registered only, no 2D texture is made
+// - wrap mode stays GL_REPEAT (an atlas would break the tiled floor and walls)
+class MaterialTextures {
+public:
+    static constexpr GLuint UNIT = 8;            // uTexArray, away from units used by passes
+    static constexpr GLuint HANDLE_BINDING = 8;  // MaterialHandles SSBO in better.frag
+    static constexpr std::uint32_t LAYER_SIZE = 1024; // every material, the bundled textures are 1024x1024
+
+    explicit MaterialTextures(TextureBinding mode); // Bindless falls back to Array when unsupported
+    static TextureBinding resolve(TextureBinding mode); // that fallback, needs the GL context
+
+    // assigns material indices to all textured meshes, meshes with the same texture share one
+    // array mode: meshes give up their texture (texture_id 0), the array layer replaces it
+    void build(const std::vector<Mesh*>& meshes, ShaderProgram& shader);
+
+    void bind() const; // once per frame, GLState skips it when still bound
+
+    TextureBinding mode() const noexcept { return m_mode; }
+    size_t size() const noexcept { return m_size; }
+
+    void clear(); // deallocate GL objects, make handles non resident - before the textures are freed
+
+private:
+    void build_array(const std::vector<Mesh*>& meshes);
+    void build_bindless();
+
+    TextureBinding m_mode;
+    std::vector<GLuint> m_textures;          // bindless: source textures, index = material index
+    std::vector<TextureResource> m_sources;  // array: source resources, index = layer - during build only
+    size_t m_size = 0;
+    std::vector<GLuint64> m_handles;
+
+    GLuint m_array{0};
+    GLuint m_handle_buffer{0};
+};
+
+#endif //MATERIALTEXTURES_HPP
@@ -0,0 +1,153 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 21.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+
+#include "MazeMeshBuilder.hpp"
+
+MazeMeshBuilder::MazeMeshBuilder(float wall_height)
+    : m_wall_height(wall_height) {}
+
+void MazeMeshBuilder::build(const Map& map, std::vector<Vertex>& out_vertices, std::vector<GLuint>& out_indices) {
+    build(map, 0, 0, static_cast<int>(map.width()), static_cast<int>(map.height()), out_vertices, out_indices);
+}
+
+void MazeMeshBuilder::build(const Map& map, int x0, int y0, int x1, int y1,
+                            std::vector<Vertex>& out_vertices, std::vector<GLuint>& out_indices) {
+    m_x0 = std::max(x0, 0);
+    m_y0 = std::max(y0, 0);
+    m_x1 = std::min(x1, static_cast<int>(map.width()));
+    m_y1 = std::min(y1, static_cast<int>(map.height()));
+
+    out_vertices.clear();
+    out_indices.clear();
+    m_vertices = &out_vertices;
+    m_indices = &out_indices;
+    m_quads = 0;
+
+    build_top(map);
+    build_sides(map);
+
+    m_vertices = nullptr;
+    m_indices = nullptr;
+}
+
+bool MazeMeshBuilder::is_wall(const Map& map, int x, int y) const {
+    // outside of map counts as empty, outer faces of the border stay visible
+    return map.get(x, y, CELL_EMPTY) == CELL_WALL;
+}
+
+void MazeMeshBuilder::build_top(const Map& map) {
+    const int w = m_x1 - m_x0;
+    const int h = m_y1 - m_y0;
+    std::vector<bool> used(static_cast<size_t>(std::max(w, 0)) * std::max(h, 0), false);
+
+    auto free_wall = [&](int x, int y) {
+        return is_wall(map, x, y) && !used[static_cast<size_t>(y - m_y0) * w + (x - m_x0)];
+    };
+
+    for (int y = m_y0; y < m_y1; ++y) {
+        for (int x = m_x0; x < m_x1; ++x) {
+            if (!free_wall(x, y))
+                continue;
+
+            // grow along X
+            int run_x = 1;
+            while (x + run_x < m_x1 && free_wall(x + run_x, y))
+                ++run_x;
+
+            // grow along Y while the whole row is free
+            int run_y = 1;
+            while (y + run_y < m_y1) {
+                bool row_ok = true;
+                for (int dx = 0; dx < run_x && row_ok; ++dx)
+                    row_ok = free_wall(x + dx, y + run_y);
+                if (!row_ok)
+                    break;
+                ++run_y;
+            }
+
+            for (int dy = 0; dy < run_y; ++dy)
+                for (int dx = 0; dx < run_x; ++dx)
+                    used[static_cast<size_t>(y + dy - m_y0) * w + (x + dx - m_x0)] = true;
+
+            emit_quad(glm::vec3(x, m_wall_height, y),
+                      glm::vec3(run_x, 0.0f, 0.0f),
+                      glm::vec3(0.0f, 0.0f, run_y),
+                      glm::vec3(0.0f, 1.0f, 0.0f),
+                      glm::vec2(run_x, run_y));
+        }
+    }
+}
+
+void MazeMeshBuilder::build_sides(const Map& map) {
+    const glm::vec3 up(0.0f, m_wall_height, 0.0f);
+
+    // faces facing -X / +X, merged into runs along Z
+    for (int side = -1; side <= 1; side += 2) {
+        for (int x = m_x0; x < m_x1; ++x) {
+            int y = m_y0;
+            while (y < m_y1) {
+                if (!is_wall(map, x, y) || is_wall(map, x + side, y)) {
+                    ++y;
+                    continue;
+                }
+                int run = 1;
+                while (y + run < m_y1 && is_wall(map, x, y + run) && !is_wall(map, x + side, y + run))
+                    ++run;
+
+                const float face_x = side > 0 ? x + 1.0f : static_cast<float>(x);
+                emit_quad(glm::vec3(face_x, 0.0f, y),
+                          glm::vec3(0.0f, 0.0f, run),
+                          up,
+                          glm::vec3(side, 0.0f, 0.0f),
+                          glm::vec2(run, 1.0f));
+                y += run;
+            }
+        }
+    }
+
+    // faces facing -Z / +Z, merged into runs along X
+    for (int side = -1; side <= 1; side += 2) {
+        for (int y = m_y0; y < m_y1; ++y) {
+            int x = m_x0;
+            while (x < m_x1) {
+                if (!is_wall(map, x, y) || is_wall(map, x, y + side)) {
+                    ++x;
+                    continue;
+                }
+                int run = 1;
+                while (x + run < m_x1 && is_wall(map, x + run, y) && !is_wall(map, x + run, y + side))
+                    ++run;
+
+                const float face_z = side > 0 ? y + 1.0f : static_cast<float>(y);
+                emit_quad(glm::vec3(x, 0.0f, face_z),
+                          glm::vec3(run, 0.0f, 0.0f),
+                          up,
+                          glm::vec3(0.0f, 0.0f, side),
+                          glm::vec2(run, 1.0f));
+                x += run;
+            }
+        }
+    }
+}
+
+void MazeMeshBuilder::emit_quad(const glm::vec3& origin, const glm::vec3& u, const glm::vec3& v,
+                                const glm::vec3& normal, const glm::vec2& uv_size) {
+    const auto base = static_cast<GLuint>(m_vertices->size());
+
+    m_vertices->push_back({origin,         normal, {0.0f,      0.0f}});
+    m_vertices->push_back({origin + u,     normal, {uv_size.x, 0.0f}});
+    m_vertices->push_back({origin + u + v, normal, {uv_size.x, uv_size.y}});
+    m_vertices->push_back({origin + v,     normal, {0.0f,      uv_size.y}});
+
+    // counter-clockwise when looking against the normal (GL_CULL_FACE keeps front faces)
+    if (glm::dot(glm::cross(u, v), normal) > 0.0f)
+        m_indices->insert(m_indices->end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+    else
+        m_indices->insert(m_indices->end(), {base, base + 3, base + 2, base + 2, base + 1, base});
+
+    ++m_quads;
+}
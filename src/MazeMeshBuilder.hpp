@@ -0,0 +1,51 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 21.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MAZEMESHBUILDER_HPP
+#define MAZEMESHBUILDER_HPP
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Map.hpp"
+#include "Vertex.hpp"
+
+// bakes all CELL_WALL cells of the map into one static vertex/index buffer
+// - faces between neighbouring walls and bottom faces (on the floor) are dropped
+// - coplanar faces are greedily merged into larger quads with tiled UVs
+class MazeMeshBuilder {
+public:
+    explicit MazeMeshBuilder(float wall_height = 2.0f);
+
+    void build(const Map& map, std::vector<Vertex>& out_vertices, std::vector<GLuint>& out_indices);
+
+    // only cells in [x0, x1) x [y0, y1), neighbours outside the region still hide shared faces
+    void build(const Map& map, int x0, int y0, int x1, int y1,
+               std::vector<Vertex>& out_vertices, std::vector<GLuint>& out_indices);
+
+    size_t quad_count() const noexcept { return m_quads; }
+
+private:
+    bool is_wall(const Map& map, int x, int y) const;
+
+    void build_top(const Map& map);
+    void build_sides(const Map& map);
+
+    // quad spanned by u and v axes from origin, uv tiled by uv_size
+    void emit_quad(const glm::vec3& origin, const glm::vec3& u, const glm::vec3& v,
+                   const glm::vec3& normal, const glm::vec2& uv_size);
+
+    float m_wall_height;
+    size_t m_quads = 0;
+
+    // region being built
+    int m_x0 = 0, m_y0 = 0, m_x1 = 0, m_y1 = 0;
+
+    std::vector<Vertex>* m_vertices = nullptr;
+    std::vector<GLuint>* m_indices = nullptr;
+};
+
+#endif //MAZEMESHBUILDER_HPP
@@ -0,0 +1,137 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 24.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include <glm/gtc/constants.hpp>
+
+#include "MazePvs.hpp"
+
+void MazePvs::build(const Map& map, int rays_per_sample) {
+    m_width = static_cast<int>(map.width());
+    m_height = static_cast<int>(map.height());
+    const size_t cells = static_cast<size_t>(m_width) * m_height;
+    m_words = (cells + 63) / 64;
+
+    m_set_index.assign(cells, -1);
+    std::int32_t sets = 0;
+    for (int y = 0; y < m_height; ++y)
+        for (int x = 0; x < m_width; ++x)
+            if (map.at(x, y) != CELL_WALL)
+                m_set_index[static_cast<size_t>(y) * m_width + x] = sets++;
+
+    m_bits.assign(static_cast<size_t>(sets) * m_words, 0);
+
+    // center and four inset corners of the cell
+    constexpr float samples[5][2] = {{0.5f, 0.5f}, {0.05f, 0.05f}, {0.95f, 0.05f}, {0.05f, 0.95f}, {0.95f, 0.95f}};
+
+    std::vector<std::uint64_t> scratch(m_words);
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            const std::int32_t set = m_set_index[static_cast<size_t>(y) * m_width + x];
+            if (set < 0)
+                continue;
+
+            std::uint64_t* bits = &m_bits[static_cast<size_t>(set) * m_words];
+            for (const auto& sample : samples) {
+                for (int r = 0; r < rays_per_sample; ++r) {
+                    const float angle = glm::two_pi<float>() * (static_cast<float>(r) + 0.5f) / static_cast<float>(rays_per_sample);
+                    cast(map, x + sample[0], y + sample[1], std::cos(angle), std::sin(angle), bits);
+                }
+            }
+            dilate(bits, scratch);
+        }
+    }
+}
+
+void MazePvs::cast(const Map& map, float ox, float oy, float dx, float dy, std::uint64_t* bits) const {
+    // Amanatides & Woo grid traversal
+    int cx = static_cast<int>(std::floor(ox));
+    int cy = static_cast<int>(std::floor(oy));
+    const int step_x = dx > 0.0f ? 1 : -1;
+    const int step_y = dy > 0.0f ? 1 : -1;
+
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    const float delta_x = dx != 0.0f ? std::abs(1.0f / dx) : inf;
+    const float delta_y = dy != 0.0f ? std::abs(1.0f / dy) : inf;
+    float t_x = dx != 0.0f ? ((step_x > 0 ? cx + 1.0f : static_cast<float>(cx)) - ox) / dx : inf;
+    float t_y = dy != 0.0f ? ((step_y > 0 ? cy + 1.0f : static_cast<float>(cy)) - oy) / dy : inf;
+
+    while (cx >= 0 && cy >= 0 && cx < m_width && cy < m_height) {
+        set_bit(bits, static_cast<size_t>(cy) * m_width + cx);
+        if (map.at(cx, cy) == CELL_WALL)
+            return;
+
+        if (t_x < t_y) {
+            t_x += delta_x;
+            cx += step_x;
+        } else {
+            t_y += delta_y;
+            cy += step_y;
+        }
+    }
+}
+
+void MazePvs::dilate(std::uint64_t* bits, std::vector<std::uint64_t>& scratch) const {
+    std::copy_n(bits, m_words, scratch.begin());
+    for (size_t word = 0; word < m_words; ++word) {
+        for (std::uint64_t w = scratch[word]; w != 0; w &= w - 1) {
+            const size_t index = word * 64 + std::countr_zero(w);
+            const int x = static_cast<int>(index % m_width);
+            const int y = static_cast<int>(index / m_width);
+            for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, m_height - 1); ++ny)
+                for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, m_width - 1); ++nx)
+                    set_bit(bits, static_cast<size_t>(ny) * m_width + nx);
+        }
+    }
+}
+
+const std::uint64_t* MazePvs::set_of(int x, int y) const noexcept {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+        return nullptr;
+    const std::int32_t set = m_set_index[static_cast<size_t>(y) * m_width + x];
+    return set < 0 ? nullptr : &m_bits[static_cast<size_t>(set) * m_words];
+}
+
+bool MazePvs::has_set(int x, int y) const noexcept {
+    return set_of(x, y) != nullptr;
+}
+
+bool MazePvs::visible(int from_x, int from_y, int x, int y) const noexcept {
+    const std::uint64_t* bits = set_of(from_x, from_y);
+    if (!bits)
+        return true;
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+        return true; // outside of maze is not occluded by it
+    return get_bit(bits, static_cast<size_t>(y) * m_width + x);
+}
+
+bool MazePvs::any_visible(int from_x, int from_y, int x0, int y0, int x1, int y1) const noexcept {
+    const std::uint64_t* bits = set_of(from_x, from_y);
+    if (!bits)
+        return true;
+    // anything reaching outside of the maze is kept
+    if (x0 < 0 || y0 < 0 || x1 >= m_width || y1 >= m_height)
+        return true;
+
+    for (int y = y0; y <= y1; ++y)
+        for (int x = x0; x <= x1; ++x)
+            if (get_bit(bits, static_cast<size_t>(y) * m_width + x))
+                return true;
+    return false;
+}
+
+size_t MazePvs::visible_count(int from_x, int from_y) const noexcept {
+    const std::uint64_t* bits = set_of(from_x, from_y);
+    if (!bits)
+        return 0;
+    size_t count = 0;
+    for (size_t word = 0; word < m_words; ++word)
+        count += std::popcount(bits[word]);
+    return count;
+}
@@ -0,0 +1,51 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 24.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MAZEPVS_HPP
+#define MAZEPVS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Map.hpp"
+
+// potentially visible set for every non-wall cell of the maze
+// - rays are marched through the grid (DDA) from a few points of each cell in all directions,
+//   every cell a ray passes (and the wall it stops at) is visible
+// - the result is dilated by one cell so grazing rays between samples are not missed
+// - one bitset of width * height bits per empty cell
+// only valid while the eye is below the wall tops
+class MazePvs {
+public:
+    MazePvs() = default;
+
+    void build(const Map& map, int rays_per_sample = 720);
+
+    bool has_set(int x, int y) const noexcept;                  // false for walls and outside of map
+    bool visible(int from_x, int from_y, int x, int y) const noexcept;
+
+    // any cell of the inclusive rectangle [x0, x1] x [y0, y1] visible from cell (from_x, from_y)
+    bool any_visible(int from_x, int from_y, int x0, int y0, int x1, int y1) const noexcept;
+
+    size_t visible_count(int from_x, int from_y) const noexcept;
+    size_t memory_bytes() const noexcept { return m_bits.size() * sizeof(std::uint64_t); }
+
+private:
+    const std::uint64_t* set_of(int x, int y) const noexcept;
+
+    void cast(const Map& map, float ox, float oy, float dx, float dy, std::uint64_t* bits) const;
+    void dilate(std::uint64_t* bits, std::vector<std::uint64_t>& scratch) const;
+
+    static void set_bit(std::uint64_t* bits, size_t index) noexcept { bits[index >> 6] |= 1ull << (index & 63); }
+    static bool get_bit(const std::uint64_t* bits, size_t index) noexcept { return (bits[index >> 6] >> (index & 63)) & 1; }
+
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_words = 0;                   // 64 bit words per set
+    std::vector<std::int32_t> m_set_index; // cell -> set, -1 for walls
+    std::vector<std::uint64_t> m_bits;
+};
+
+#endif //MAZEPVS_HPP
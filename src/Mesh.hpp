@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -7,7 +11,11 @@
 #include <glm/ext.hpp>
 
 #include "Vertex.hpp"
+#include "MeshCache.hpp"
+#include "MeshData.hpp"
+#include "ResourceManager.hpp"
 #include "ShaderProgram.hpp"
+#include "GLState.hpp"
 #include <iostream>
 
 class Mesh {
@@ -16,10 +24,17 @@ public:
     glm::vec3 origin{};
     glm::vec3 orientation{};
 
-    std::vector<Vertex> vertices;
-    std::vector<GLuint> indices;
+    // CPU side geometry (GpuScene, bounds), views into storage - owned or the mapped mesh cache file
+    std::span<const Vertex> vertices;
+    std::span<const GLuint> indices; // full detail level
+    glm::vec3 bounds_min{0.0f};
+    glm::vec3 bounds_max{0.0f};
     
     GLuint texture_id{0}; // texture id=0  means no texture
+    // references held by this mesh, released in clear()
+    TextureResource texture_resource;
+    MeshResource mesh_resource;
+    int material_index{-1}; // >= 0: texture comes from MaterialTextures, tex0 is not bound
     GLenum primitive_type = GL_POINT;//GL_TRIANGLES;
     ShaderProgram &shader;
     
@@ -28,45 +43,32 @@ public:
     glm::vec4 diffuse_material{1.0f}; //white, non-transparent 
     glm::vec4 specular_material{1.0f}; //white, non-transparent
     float reflectivity{1.0f}; 
+
+    // vertex format, chosen per mesh when the GPU buffers are created
+    inline static bool packed_formats = true; // PackedVertex + 16 bit indices where possible
+    bool packed{false};
+    GLenum index_type{GL_UNSIGNED_INT};
+    glm::vec3 position_scale{1.0f};  // packed positions: aabb extent
+    glm::vec3 position_offset{0.0f}; // packed positions: aabb min
+
+    // level of detail ranges in the EBO, lods[0] is indices, following levels are coarser
+    std::vector<LodRange> lods;
     
-    // indirect (indexed) draw 
-	Mesh(GLenum primitive_type, ShaderProgram & shader, std::vector<Vertex> const & vertices, std::vector<GLuint> const & indices, glm::vec3 const & origin, glm::vec3 const & orientation, GLuint const texture_id = 0):
+    // indirect (indexed) draw, buffers are created straight from the spans of data (no staging copies)
+    Mesh(GLenum primitive_type, ShaderProgram & shader, MeshData const & data, glm::vec3 const & origin, glm::vec3 const & orientation, GLuint const texture_id = 0):
         primitive_type(primitive_type),
         shader(shader),
-        vertices(vertices),
-        indices(indices),
         origin(origin),
         orientation(orientation),
         texture_id(texture_id) {
 
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-
-        // Bind and fill vertex buffer
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-
-        // Bind and fill index buffer
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-
-        // Define vertex attributes 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_position));  // Position
-
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_normal));  // Normal
-
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_tex_coords));  // Texture Coordinates
-
-        glBindVertexArray(0); // Unbind VAO
-        
+        upload(data);
     };
 
+    // geometry built at runtime (maze chunks), copied into storage owned by the mesh
+	Mesh(GLenum primitive_type, ShaderProgram & shader, std::vector<Vertex> const & vertices, std::vector<GLuint> const & indices, glm::vec3 const & origin, glm::vec3 const & orientation, GLuint const texture_id = 0):
+        Mesh(primitive_type, shader, MeshCache::assemble(vertices, indices, {}, packed_formats), origin, orientation, texture_id) {}
+
     
     void draw(glm::vec3 const & offset, glm::vec3 const & rotation) {
  		if (VAO == 0) {//VAO=VERTEXT ARRAY OBJECT
@@ -75,22 +77,27 @@ public:
 		}
  
         shader.activate();
+        bind_format();
         // Bind texture if available
         if (texture_id > 0) {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texture_id);
-            //shader.setUniform("tex0", 0);
-            glUniform1i(glGetUniformLocation(shader.ID, "tex0"), 0); // Set texture unit in fragment shader
+            GLState::bind_texture(0, texture_id);
+            shader.setUniform("tex0"_u, 0); // Set texture unit in fragment shader
         }
         
-        glBindVertexArray(VAO);
+        GLState::bind_vertex_array(VAO);
         
-        glDrawElements(primitive_type, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+        glDrawElements(primitive_type, static_cast<GLsizei>(indices.size()), index_type, 0);
         //glDrawArrays(primitive_type, 0, vertices.size()); 
         
         //glBindVertexArray(0);
     }
     void draw(glm::mat4 const& model_matrix) {
+        // normal matrix is precomputed here instead of per vertex
+        draw(model_matrix, glm::mat3(glm::transpose(glm::inverse(model_matrix))));
+    }
+
+    // normal matrix cached by the caller (Scene)
+    void draw(glm::mat4 const& model_matrix, glm::mat3 const& normal_matrix, size_t lod = 0) {
         if (VAO == 0) {
             std::cerr << "VAO not initialized!\n";
             return;
@@ -98,41 +105,145 @@ public:
 
         shader.activate();
 
-        // Set model matrix uniform in the shader
-        shader.setUniform("uM_m", model_matrix);
-        shader.setUniform("matAmbient", glm::vec3(0.1f, 0.1f, 0.1f));
-        shader.setUniform("matSpecular", glm::vec3(0.8f, 0.8f, 0.8f));
-        shader.setUniform("matShininess", 32.0f);
+        shader.setUniform("uInstanced"_u, 0);
+        shader.setUniform("uM_m"_u, model_matrix);
+        shader.setUniform("uN_m"_u, normal_matrix);
+        bind_format();
+        bind_material();
+
+        // VAO stays bound, consecutive draws of the same mesh skip the rebind
+        GLState::bind_vertex_array(VAO);
+        const LodRange& level = lods[std::min(lod, lods.size() - 1)];
+        const size_t index_size = index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        glDrawElements(primitive_type, level.index_count, index_type, (void*)(level.first_index * index_size));
+    }
+
+    // coarsest level whose error projects under threshold_px pixels
+    // hysteresis: a coarser level than current must get 25 % under the threshold first
+    size_t select_lod(float pixels_per_unit, size_t current, float threshold_px) const {
+        for (size_t lod = lods.size() - 1; lod > 0; --lod) {
+            const float limit = lod > current ? threshold_px * 0.75f : threshold_px;
+            if (lods[lod].error * pixels_per_unit <= limit)
+                return lod;
+        }
+        return 0;
+    }
 
-        if (texture_id > 0) {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texture_id);
-            //shader.setUniform("tex0", 0);
-            glUniform1i(glGetUniformLocation(shader.ID, "tex0"), 0); // Set texture unit in fragment shader
+    // instanced draw - model and normal matrices are read from the instance SSBO bound by the caller
+    void draw_instanced(GLsizei instance_count) {
+        if (VAO == 0) {
+            std::cerr << "VAO not initialized!\n";
+            return;
         }
 
-        glBindVertexArray(VAO);
-        glDrawElements(primitive_type, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        shader.activate();
+        shader.setUniform("uInstanced"_u, 1);
+        bind_format();
+        bind_material();
+
+        GLState::bind_vertex_array(VAO);
+        glDrawElementsInstanced(primitive_type, static_cast<GLsizei>(indices.size()), index_type, 0, instance_count);
     }
 
-	void clear(void) {
-        if (texture_id) {   // or all textures in vector...
-            glDeleteTextures(1, &texture_id);
+    // position dequantization, identity for float vertices
+    void bind_format() {
+        shader.setUniform("uPosScale"_u, position_scale);
+        shader.setUniform("uPosOffset"_u, position_offset);
+    }
+
+    // bytes of vertex + index data on the GPU
+    size_t gpu_bytes() const noexcept {
+        return vertices.size() * (packed ? sizeof(PackedVertex) : sizeof(Vertex))
+             + (lods.empty() ? 0 : lods.back().first_index + lods.back().index_count) * (index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint));
+    }
+
+    // material uniforms and texture, shared by all draw paths
+    void bind_material() {
+        shader.setUniform("matAmbient"_u, glm::vec3(0.1f, 0.1f, 0.1f));
+        shader.setUniform("matSpecular"_u, glm::vec3(0.8f, 0.8f, 0.8f));
+        shader.setUniform("matShininess"_u, 32.0f);
+        shader.setUniform("matOpacity"_u, diffuse_material.w);
+        shader.setUniform("uMaterial"_u, material_index);
+
+        if (texture_id > 0 && material_index < 0) {
+            GLState::bind_texture(0, texture_id);
+            shader.setUniform("tex0"_u, 0); // Set texture unit in fragment shader
         }
+    }
+
+    GLuint vao() const noexcept { return VAO; }
+    GLuint bound_texture() const noexcept { return material_index < 0 ? texture_id : 0; } // tex0 bound per draw
+
+	void clear(void) {
+        // texture may be shared with other meshes, the resource manager frees it with the last reference
+        ResourceManager::release(texture_resource);
+        ResourceManager::release(mesh_resource);
+        texture_resource = {};
+        mesh_resource = {};
         texture_id = 0;
         primitive_type = GL_POINT;
-        vertices.clear();
-        indices.clear();
+        vertices = {};
+        indices = {};
+        storage.reset();
+        lods.clear();
 
         glDeleteBuffers(1, &VBO);
         glDeleteBuffers(1, &EBO);
         glDeleteVertexArrays(1, &VAO);
+        GLState::invalidate(); // deleted names may be reused
         
         
     };
 
 private:
+    void upload(MeshData const & data) {
+        vertices = data.vertices;
+        lods = data.lods;
+        indices = data.level_indices(0);
+        bounds_min = data.bounds_min;
+        bounds_max = data.bounds_max;
+        storage = data.storage;
+
+        glCreateVertexArrays(1, &VAO);
+        glCreateBuffers(1, &VBO);
+        glCreateBuffers(1, &EBO);
+
+        packed = packed_formats && !data.packed_vertices.empty();
+        if (packed) {
+            position_offset = bounds_min;
+            position_scale = bounds_max - bounds_min;
+            index_type = data.packed_index_type;
+            buffer_storage(VBO, std::as_bytes(data.packed_vertices));
+            buffer_storage(EBO, data.packed_indices);
+            glVertexArrayVertexBuffer(VAO, 0, VBO, 0, sizeof(PackedVertex));
+            attribute(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PackedVertex, m_position));
+            attribute(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, m_normal));
+            attribute(2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, m_tex_coords));
+        } else {
+            index_type = GL_UNSIGNED_INT;
+            buffer_storage(VBO, std::as_bytes(data.vertices));
+            buffer_storage(EBO, std::as_bytes(data.indices));
+            glVertexArrayVertexBuffer(VAO, 0, VBO, 0, sizeof(Vertex));
+            attribute(0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_position));
+            attribute(1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_normal));
+            attribute(2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_tex_coords));
+        }
+        glVertexArrayElementBuffer(VAO, EBO);
+    }
+
+    // immutable storage, zero sized buffers are not allowed
+    static void buffer_storage(GLuint buffer, std::span<const std::byte> bytes) {
+        glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(std::max<size_t>(bytes.size(), 1)), bytes.empty() ? nullptr : bytes.data(), 0);
+    }
+
+    void attribute(GLuint index, GLint components, GLenum type, GLboolean normalized, size_t offset) {
+        glEnableVertexArrayAttrib(VAO, index);
+        glVertexArrayAttribFormat(VAO, index, components, type, normalized, static_cast<GLuint>(offset));
+        glVertexArrayAttribBinding(VAO, index, 0);
+    }
+
+    std::shared_ptr<const void> storage; // keeps vertices / indices alive
+
     // OpenGL buffer IDs
     // ID = 0 is reserved (i.e. uninitalized)
      unsigned int VAO{0}, VBO{0}, EBO{0};
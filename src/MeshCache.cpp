@@ -0,0 +1,261 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 5.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include "MeshCache.hpp"
+#include "Logger.hpp"
+#include "MappedFile.hpp"
+#include "ResourceManager.hpp"
+
+namespace {
+    constexpr std::uint64_t ALIGNMENT = 256; // blob offsets, fine for any buffer upload path
+    constexpr std::uint32_t MAX_LODS = 16;
+
+    // vertex attribute as passed to glVertexArrayAttribFormat
+    struct Attribute {
+        std::uint32_t components;
+        std::uint32_t type;
+        std::uint32_t normalized;
+        std::uint32_t offset;
+    };
+
+    struct Layout {
+        std::uint32_t stride;
+        Attribute attributes[3]; // position, normal, uv
+    };
+
+    struct Blob {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t key;
+        std::uint32_t vertex_count;
+        std::uint32_t index_count; // all levels
+        std::uint32_t lod_count;   // LodRange table follows the header
+        std::uint32_t packed_index_type; // 0 = no packed layout
+        float bounds_min[3];
+        float bounds_max[3];
+        Layout float_layout;
+        Layout packed_layout;
+        Blob vertices, indices, packed_vertices, packed_indices;
+    };
+
+    // a layout change without a VERSION bump still invalidates old files
+    constexpr Layout FLOAT_LAYOUT{sizeof(Vertex), {
+        {3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_position)},
+        {3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_normal)},
+        {2, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_tex_coords)}}};
+    constexpr Layout PACKED_LAYOUT{sizeof(PackedVertex), {
+        {3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PackedVertex, m_position)},
+        {4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, m_normal)},
+        {2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, m_tex_coords)}}};
+
+    // storage of an assembled (not cached) mesh
+    struct Owned {
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+        std::vector<PackedVertex> packed_vertices;
+        std::vector<GLushort> short_indices;
+    };
+
+    std::uint64_t align(std::uint64_t offset) { return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    bool inside(const Blob& blob, std::uint64_t file_size) {
+        return blob.offset % ALIGNMENT == 0 && blob.offset <= file_size && blob.size <= file_size - blob.offset;
+    }
+
+    template <typename T>
+    std::span<const T> view(const MappedFile& file, const Blob& blob) {
+        return {reinterpret_cast<const T*>(file.data() + blob.offset), static_cast<size_t>(blob.size / sizeof(T))};
+    }
+}
+
+MeshData MeshCache::assemble(std::vector<Vertex> vertices, std::vector<GLuint> indices, const std::vector<LodLevel>& lods, bool packed) {
+    auto owned = std::make_shared<Owned>();
+    owned->vertices = std::move(vertices);
+    owned->indices = std::move(indices);
+
+    MeshData data;
+    // all levels share one index buffer
+    data.lods.push_back({0, static_cast<GLsizei>(owned->indices.size()), 0.0f});
+    for (const auto& level : lods) {
+        data.lods.push_back({static_cast<GLuint>(owned->indices.size()), static_cast<GLsizei>(level.indices.size()), level.error});
+        owned->indices.insert(owned->indices.end(), level.indices.begin(), level.indices.end());
+    }
+
+    if (!owned->vertices.empty()) {
+        data.bounds_min = data.bounds_max = owned->vertices[0].m_position;
+        for (const auto& v : owned->vertices) {
+            data.bounds_min = glm::min(data.bounds_min, v.m_position);
+            data.bounds_max = glm::max(data.bounds_max, v.m_position);
+        }
+    }
+
+    if (packed && !owned->vertices.empty()) {
+        const glm::vec3 lo = data.bounds_min;
+        const glm::vec3 extent = data.bounds_max - data.bounds_min;
+        owned->packed_vertices.resize(owned->vertices.size());
+        for (size_t i = 0; i < owned->vertices.size(); ++i) {
+            const Vertex& v = owned->vertices[i];
+            PackedVertex& p = owned->packed_vertices[i];
+            for (int axis = 0; axis < 3; ++axis)
+                p.m_position[axis] = extent[axis] > 0.0f ? vertex_pack::unorm16((v.m_position[axis] - lo[axis]) / extent[axis]) : 0;
+            p.m_position[3] = 0;
+            p.m_normal = vertex_pack::snorm_2_10_10_10(v.m_normal);
+            p.m_tex_coords[0] = vertex_pack::half(v.m_tex_coords.x);
+            p.m_tex_coords[1] = vertex_pack::half(v.m_tex_coords.y);
+        }
+
+        // every index fits into 16 bits
+        if (owned->vertices.size() <= 0x10000) {
+            owned->short_indices.assign(owned->indices.begin(), owned->indices.end());
+            data.packed_indices = std::as_bytes(std::span<const GLushort>(owned->short_indices));
+            data.packed_index_type = GL_UNSIGNED_SHORT;
+        } else {
+            data.packed_indices = std::as_bytes(std::span<const GLuint>(owned->indices));
+            data.packed_index_type = GL_UNSIGNED_INT;
+        }
+        data.packed_vertices = owned->packed_vertices;
+    }
+
+    data.vertices = owned->vertices;
+    data.indices = owned->indices;
+    data.storage = std::move(owned);
+    return data;
+}
+
+std::filesystem::path MeshCache::path_of(std::uint64_t source_key) {
+    const std::uint64_t key = ResourceManager::hash(&VERSION, sizeof(VERSION), source_key);
+    char file_name[32];
+    std::snprintf(file_name, sizeof(file_name), "%016llx.bmesh", static_cast<unsigned long long>(key));
+    return cache_dir / file_name;
+}
+
+std::optional<MeshData> MeshCache::load(std::uint64_t source_key, const std::string& name) {
+    const std::filesystem::path path = path_of(source_key);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec))
+        return std::nullopt;
+
+    std::shared_ptr<const MappedFile> file;
+    try {
+        file = std::make_shared<const MappedFile>(path);
+    } catch (const std::exception& e) {
+        Logger::warning(std::string("Mesh cache: ") + e.what());
+        return std::nullopt;
+    }
+
+    const auto invalid = [&] {
+        Logger::warning("Mesh cache: ignoring invalid " + path.string() + " (" + name + ")");
+        return std::nullopt;
+    };
+
+    Header header{};
+    if (file->size() < sizeof(header))
+        return invalid();
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    const bool has_packed = header.packed_index_type != 0;
+    const size_t packed_index_size = header.packed_index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    if (std::memcmp(header.magic, "BMSH", 4) != 0 || header.version != VERSION || header.key != source_key
+        || std::memcmp(&header.float_layout, &FLOAT_LAYOUT, sizeof(Layout)) != 0
+        || std::memcmp(&header.packed_layout, &PACKED_LAYOUT, sizeof(Layout)) != 0
+        || header.lod_count == 0 || header.lod_count > MAX_LODS
+        || sizeof(Header) + header.lod_count * sizeof(LodRange) > file->size()
+        || !inside(header.vertices, file->size()) || !inside(header.indices, file->size())
+        || !inside(header.packed_vertices, file->size()) || !inside(header.packed_indices, file->size())
+        || header.vertices.size != std::uint64_t{header.vertex_count} * sizeof(Vertex)
+        || header.indices.size != std::uint64_t{header.index_count} * sizeof(GLuint)
+        || (has_packed && (header.packed_index_type != GL_UNSIGNED_SHORT && header.packed_index_type != GL_UNSIGNED_INT))
+        || header.packed_vertices.size != (has_packed ? std::uint64_t{header.vertex_count} * sizeof(PackedVertex) : 0)
+        || header.packed_indices.size != (has_packed ? std::uint64_t{header.index_count} * packed_index_size : 0))
+        return invalid();
+
+    MeshData data;
+    data.lods.resize(header.lod_count);
+    std::memcpy(data.lods.data(), file->data() + sizeof(Header), header.lod_count * sizeof(LodRange));
+    for (const LodRange& level : data.lods)
+        if (level.index_count < 0 || std::uint64_t{level.first_index} + static_cast<std::uint64_t>(level.index_count) > header.index_count)
+            return invalid();
+
+    data.bounds_min = glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]);
+    data.bounds_max = glm::vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]);
+    // the blobs are not copied, the mapping lives as long as any MeshData or Mesh referencing it
+    data.vertices = view<Vertex>(*file, header.vertices);
+    data.indices = view<GLuint>(*file, header.indices);
+    if (has_packed) {
+        data.packed_vertices = view<PackedVertex>(*file, header.packed_vertices);
+        data.packed_indices = view<std::byte>(*file, header.packed_indices);
+        data.packed_index_type = header.packed_index_type;
+    }
+    data.storage = std::move(file);
+    return data;
+}
+
+void MeshCache::store(std::uint64_t source_key, const MeshData& data, const std::string& name) {
+    const std::filesystem::path path = path_of(source_key);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    const bool has_packed = !data.packed_vertices.empty();
+    Header header{{'B', 'M', 'S', 'H'}, VERSION, source_key,
+                  static_cast<std::uint32_t>(data.vertices.size()), static_cast<std::uint32_t>(data.indices.size()),
+                  static_cast<std::uint32_t>(data.lods.size()), has_packed ? data.packed_index_type : 0,
+                  {data.bounds_min.x, data.bounds_min.y, data.bounds_min.z},
+                  {data.bounds_max.x, data.bounds_max.y, data.bounds_max.z},
+                  FLOAT_LAYOUT, PACKED_LAYOUT, {}, {}, {}, {}};
+
+    std::uint64_t offset = sizeof(Header) + data.lods.size() * sizeof(LodRange);
+    const auto place = [&](Blob& blob, std::span<const std::byte> bytes) {
+        offset = align(offset);
+        blob = {offset, bytes.size()};
+        offset += bytes.size();
+    };
+    place(header.vertices, std::as_bytes(data.vertices));
+    place(header.indices, std::as_bytes(data.indices));
+    place(header.packed_vertices, std::as_bytes(data.packed_vertices));
+    if (header.packed_index_type == GL_UNSIGNED_SHORT)
+        place(header.packed_indices, data.packed_indices);
+    else if (has_packed)
+        header.packed_indices = header.indices; // same 32 bit indices, stored once
+
+    // written aside and renamed, a mapped older file is never truncated under its reader
+    std::filesystem::path temp = path;
+    temp += "." + std::to_string(std::random_device{}()) + ".tmp"; // unique across threads and processes
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.lods.data()), static_cast<std::streamsize>(data.lods.size() * sizeof(LodRange)));
+        const auto write = [&](const Blob& blob, std::span<const std::byte> bytes) {
+            static constexpr char zeros[ALIGNMENT]{};
+            file.write(zeros, static_cast<std::streamsize>(blob.offset - static_cast<std::uint64_t>(file.tellp())));
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        };
+        write(header.vertices, std::as_bytes(data.vertices));
+        write(header.indices, std::as_bytes(data.indices));
+        write(header.packed_vertices, std::as_bytes(data.packed_vertices));
+        if (header.packed_index_type == GL_UNSIGNED_SHORT)
+            write(header.packed_indices, data.packed_indices);
+        if (!file) {
+            Logger::warning("Mesh cache: cannot write " + path.string() + " (" + name + ")");
+            file.close();
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        Logger::warning("Mesh cache: cannot write " + path.string() + " (" + name + "): " + ec.message());
+        std::filesystem::remove(temp, ec);
+    }
+}
@@ -0,0 +1,42 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 5.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MESHCACHE_HPP
+#define MESHCACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "MeshData.hpp"
+#include "Vertex.hpp"
+
+// binary mesh cache, an imported OBJ is parsed, optimized and simplified once
+// - .bmesh = header, vertex layout descriptors, LOD table, then the vertex / index blobs of both layouts
+// - blobs are 256 B aligned, a hit maps the file and MeshData points straight into it
+// - file name = hash of the source key (ResourceManager: path + contents) and VERSION, invalid files are rebuilt
+class MeshCache {
+public:
+    static constexpr std::uint32_t VERSION = 1; // bump when the import pipeline changes, invalidates the cache
+
+    inline static bool enabled = true; // config mesh_cache
+    inline static std::filesystem::path cache_dir = "cache/meshes";
+
+    // owning MeshData, float layout always, packed layout if requested
+    static MeshData assemble(std::vector<Vertex> vertices, std::vector<GLuint> indices,
+                             const std::vector<LodLevel>& lods = {}, bool packed = true);
+
+    // mapped cache entry, nullopt on a miss
+    static std::optional<MeshData> load(std::uint64_t source_key, const std::string& name);
+    static void store(std::uint64_t source_key, const MeshData& data, const std::string& name);
+
+private:
+    static std::filesystem::path path_of(std::uint64_t source_key);
+};
+
+#endif //MESHCACHE_HPP
@@ -0,0 +1,51 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 30.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MESHDATA_HPP
+#define MESHDATA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Vertex.hpp"
+
+// coarser index list over the same vertices (MeshSimplifier)
+struct LodLevel {
+    std::vector<GLuint> indices;
+    float error{0.0f}; // object space
+};
+
+// one level of detail in the shared index buffer
+struct LodRange {
+    GLuint first_index{0};
+    GLsizei index_count{0};
+    float error{0.0f}; // object space
+};
+
+// geometry ready for upload (optimized, with LOD chain), built by MeshCache
+// - the spans point into storage: vectors after an import, the mapped .bmesh file after a cache hit
+// - both vertex layouts, Mesh uploads the one selected by Mesh::packed_formats straight from the spans
+struct MeshData {
+    std::span<const Vertex> vertices;
+    std::span<const GLuint> indices; // all levels back to back
+    std::vector<LodRange> lods;      // lods[0] = full detail
+    glm::vec3 bounds_min{0.0f};
+    glm::vec3 bounds_max{0.0f};
+
+    // packed layout, positions relative to the bounds; empty if not built
+    std::span<const PackedVertex> packed_vertices;
+    std::span<const std::byte> packed_indices; // 16 bit when the vertex count allows it, else the 32 bit indices
+    GLenum packed_index_type{GL_UNSIGNED_INT};
+
+    std::shared_ptr<const void> storage; // keeps the spans alive, shared by copies
+
+    std::span<const GLuint> level_indices(size_t lod) const { return indices.subspan(lods[lod].first_index, lods[lod].index_count); }
+};
+
+#endif //MESHDATA_HPP
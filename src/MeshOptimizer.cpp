@@ -0,0 +1,271 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 28.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+
+#include "MeshOptimizer.hpp"
+#include "Logger.hpp"
+
+namespace {
+    constexpr GLuint UNUSED = 0xFFFFFFFFu;
+
+    // triangles around every vertex, CSR layout
+    struct Adjacency {
+        std::vector<std::uint32_t> offsets; // vertex_count + 1
+        std::vector<std::uint32_t> triangles;
+    };
+
+    Adjacency build_adjacency(const std::vector<GLuint>& indices, size_t vertex_count) {
+        Adjacency adjacency;
+        adjacency.offsets.assign(vertex_count + 1, 0);
+        for (const GLuint index : indices)
+            ++adjacency.offsets[index + 1];
+        std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+        adjacency.triangles.resize(indices.size());
+        std::vector<std::uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            adjacency.triangles[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        return adjacency;
+    }
+
+    // per triangle count of vertices missing in a FIFO cache
+    std::vector<std::uint8_t> simulate_misses(const std::vector<GLuint>& indices, size_t vertex_count, size_t cache_size) {
+        std::vector<std::uint32_t> timestamps(vertex_count, 0);
+        std::uint32_t time = static_cast<std::uint32_t>(cache_size) + 1;
+        std::vector<std::uint8_t> misses(indices.size() / 3, 0);
+
+        for (size_t i = 0; i < indices.size(); ++i) {
+            const GLuint v = indices[i];
+            if (time - timestamps[v] > cache_size) {
+                timestamps[v] = time++;
+                ++misses[i / 3];
+            }
+        }
+        return misses;
+    }
+
+    std::string format_stats(const MeshOptimizer::CacheStats& stats) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "ACMR %.3f ATVR %.3f", stats.acmr, stats.atvr);
+        return buffer;
+    }
+}
+
+void MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<GLuint>& indices, const std::string& name) {
+    if (indices.size() < 3 || indices.size() % 3 != 0 || vertices.empty())
+        return;
+    if (*std::ranges::max_element(indices) >= vertices.size()) {
+        Logger::warning("Mesh not optimized, index out of range: " + name);
+        return;
+    }
+
+    const CacheStats before = analyze(indices, vertices.size());
+    optimize_vertex_cache(indices, vertices.size());
+    optimize_overdraw(indices, vertices);
+    optimize_vertex_fetch(vertices, indices);
+    const CacheStats after = analyze(indices, vertices.size());
+
+    Logger::info("Mesh optimized: " + name + " (" + std::to_string(indices.size() / 3) + " triangles) "
+                 + format_stats(before) + " -> " + format_stats(after));
+}
+
+void MeshOptimizer::optimize_vertex_cache(std::vector<GLuint>& indices, size_t vertex_count, size_t cache_size) {
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+        return;
+
+    const Adjacency adjacency = build_adjacency(indices, vertex_count);
+
+    std::vector<std::uint32_t> live(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v)
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+    std::vector<std::uint32_t> cache_time(vertex_count, 0);
+    std::uint32_t time = static_cast<std::uint32_t>(cache_size) + 1;
+    std::vector<std::uint8_t> emitted(triangle_count, 0);
+
+    std::vector<GLuint> dead_end;
+    std::vector<GLuint> candidates;
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+
+    GLuint cursor = 0;
+    // dead end: most recently touched vertex with live triangles, otherwise next one in input order
+    auto skip_dead_end = [&]() -> GLuint {
+        while (!dead_end.empty()) {
+            const GLuint v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0)
+                return v;
+        }
+        for (; cursor < vertex_count; ++cursor)
+            if (live[cursor] > 0)
+                return cursor;
+        return UNUSED;
+    };
+
+    GLuint fan = skip_dead_end();
+    while (fan != UNUSED) {
+        candidates.clear();
+        for (std::uint32_t k = adjacency.offsets[fan]; k < adjacency.offsets[fan + 1]; ++k) {
+            const std::uint32_t t = adjacency.triangles[k];
+            if (emitted[t])
+                continue;
+            emitted[t] = 1;
+            for (int c = 0; c < 3; ++c) {
+                const GLuint v = indices[t * 3 + c];
+                result.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - cache_time[v] > cache_size)
+                    cache_time[v] = time++;
+            }
+        }
+
+        // next fan: vertex that stays in cache after emitting all its live triangles, the oldest one wins
+        GLuint best = UNUSED;
+        int best_priority = -1;
+        for (const GLuint v : candidates) {
+            if (live[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - cache_time[v] + 2 * live[v] <= cache_size)
+                priority = static_cast<int>(time - cache_time[v]);
+            if (priority > best_priority) {
+                best_priority = priority;
+                best = v;
+            }
+        }
+        fan = best != UNUSED ? best : skip_dead_end();
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimize_overdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold) {
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count < 2)
+        return;
+
+    const std::vector<std::uint8_t> misses = simulate_misses(indices, vertices.size(), CACHE_SIZE);
+    size_t total_misses = 0;
+    for (const std::uint8_t m : misses)
+        total_misses += m;
+    const float split_acmr = static_cast<float>(total_misses) / static_cast<float>(triangle_count) * threshold;
+
+    // hard boundary: cache restart (all 3 vertices miss)
+    // soft boundary: the cluster so far is cheap enough and the next triangle starts over anyway
+    std::vector<std::uint32_t> cluster_start{0};
+    size_t cluster_misses = misses[0];
+    for (size_t t = 1; t < triangle_count; ++t) {
+        const size_t cluster_size = t - cluster_start.back();
+        const bool hard = misses[t] == 3;
+        const bool soft = misses[t] >= 2
+                          && static_cast<float>(cluster_misses) <= split_acmr * static_cast<float>(cluster_size);
+        if (hard || soft) {
+            cluster_start.push_back(static_cast<std::uint32_t>(t));
+            cluster_misses = 0;
+        }
+        cluster_misses += misses[t];
+    }
+    cluster_start.push_back(static_cast<std::uint32_t>(triangle_count));
+    const size_t cluster_count = cluster_start.size() - 1;
+    if (cluster_count < 2)
+        return;
+
+    // mesh centroid, area weighted
+    std::vector<glm::vec3> cluster_centroid(cluster_count, glm::vec3(0.0f));
+    std::vector<glm::vec3> cluster_normal(cluster_count, glm::vec3(0.0f));
+    std::vector<float> cluster_area(cluster_count, 0.0f);
+    glm::vec3 mesh_centroid(0.0f);
+    float mesh_area = 0.0f;
+
+    for (size_t c = 0; c < cluster_count; ++c) {
+        for (std::uint32_t t = cluster_start[c]; t < cluster_start[c + 1]; ++t) {
+            const glm::vec3& p0 = vertices[indices[t * 3 + 0]].m_position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].m_position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].m_position;
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0); // length = 2 * area
+            const float area = glm::length(n);
+            const glm::vec3 center = (p0 + p1 + p2) / 3.0f;
+
+            cluster_centroid[c] += center * area;
+            cluster_normal[c] += n;
+            cluster_area[c] += area;
+        }
+        mesh_centroid += cluster_centroid[c];
+        mesh_area += cluster_area[c];
+    }
+    if (mesh_area <= 0.0f)
+        return;
+    mesh_centroid /= mesh_area;
+
+    // clusters facing away from the center are likely in front of the rest, draw them first
+    std::vector<float> sort_key(cluster_count, 0.0f);
+    for (size_t c = 0; c < cluster_count; ++c) {
+        if (cluster_area[c] <= 0.0f)
+            continue;
+        const float normal_length = glm::length(cluster_normal[c]);
+        if (normal_length <= 0.0f)
+            continue;
+        const glm::vec3 centroid = cluster_centroid[c] / cluster_area[c];
+        sort_key[c] = glm::dot(centroid - mesh_centroid, cluster_normal[c] / normal_length);
+    }
+
+    std::vector<std::uint32_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, std::greater{}, [&](std::uint32_t c) { return sort_key[c]; });
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    for (const std::uint32_t c : order)
+        result.insert(result.end(), indices.begin() + cluster_start[c] * 3, indices.begin() + cluster_start[c + 1] * 3);
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimize_vertex_fetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+    std::vector<GLuint> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (GLuint& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<GLuint>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::analyze(const std::vector<GLuint>& indices, size_t vertex_count, size_t cache_size) {
+    CacheStats stats;
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0 || vertex_count == 0)
+        return stats;
+
+    const std::vector<std::uint8_t> misses = simulate_misses(indices, vertex_count, cache_size);
+    size_t total = 0;
+    for (const std::uint8_t m : misses)
+        total += m;
+
+    std::vector<std::uint8_t> used(vertex_count, 0);
+    size_t unique = 0;
+    for (const GLuint index : indices) {
+        if (!used[index]) {
+            used[index] = 1;
+            ++unique;
+        }
+    }
+
+    stats.acmr = static_cast<float>(total) / static_cast<float>(triangle_count);
+    stats.atvr = static_cast<float>(total) / static_cast<float>(unique);
+    return stats;
+}
@@ -0,0 +1,42 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 28.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Vertex.hpp"
+
+// post import optimization of indexed triangle lists
+// 1. vertex cache - Tipsify (Sander, Nehab, Barczak 2007)
+// 2. overdraw     - cache clusters sorted outside-in, clusters stay intact so the cache order survives
+// 3. fetch        - vertices renumbered in first use order, unreferenced vertices dropped
+class MeshOptimizer {
+public:
+    static constexpr size_t CACHE_SIZE = 16; // FIFO size used for optimization and statistics
+
+    struct CacheStats {
+        float acmr = 0.0f; // average cache miss ratio, transformed vertices per triangle (0.5 .. 3)
+        float atvr = 0.0f; // average transformed vertex ratio, transformed / unique vertices (1 is ideal)
+    };
+
+    // all three steps, logs statistics before and after
+    static void optimize(std::vector<Vertex>& vertices, std::vector<GLuint>& indices, const std::string& name);
+
+    static void optimize_vertex_cache(std::vector<GLuint>& indices, size_t vertex_count, size_t cache_size = CACHE_SIZE);
+
+    // threshold - allowed ACMR increase for finer clusters (1.05 = 5 %)
+    static void optimize_overdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+
+    static void optimize_vertex_fetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+
+    // FIFO cache simulation
+    static CacheStats analyze(const std::vector<GLuint>& indices, size_t vertex_count, size_t cache_size = CACHE_SIZE);
+};
+
+#endif //MESHOPTIMIZER_HPP
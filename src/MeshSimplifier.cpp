@@ -0,0 +1,261 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 29.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include "MeshSimplifier.hpp"
+#include "MeshOptimizer.hpp"
+
+namespace {
+    // p^T A p + 2 b.p + c, sum of squared distances to the accumulated planes
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0;
+        double c = 0;
+
+        static Quadric plane(const glm::vec3& n, float d) {
+            Quadric q;
+            q.a00 = n.x * n.x; q.a01 = n.x * n.y; q.a02 = n.x * n.z;
+            q.a11 = n.y * n.y; q.a12 = n.y * n.z; q.a22 = n.z * n.z;
+            q.b0 = n.x * d; q.b1 = n.y * d; q.b2 = n.z * d;
+            q.c = static_cast<double>(d) * d;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& o) {
+            a00 += o.a00; a01 += o.a01; a02 += o.a02; a11 += o.a11; a12 += o.a12; a22 += o.a22;
+            b0 += o.b0; b1 += o.b1; b2 += o.b2;
+            c += o.c;
+            return *this;
+        }
+
+        double evaluate(const glm::vec3& p) const {
+            const double x = p.x, y = p.y, z = p.z;
+            return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + a11 * y * y + 2 * a12 * y * z + a22 * z * z
+                 + 2 * (b0 * x + b1 * y + b2 * z) + c;
+        }
+    };
+
+    struct PositionKey {
+        std::uint32_t x, y, z;
+        bool operator==(const PositionKey&) const = default;
+    };
+
+    struct PositionHash {
+        size_t operator()(const PositionKey& k) const noexcept {
+            return (k.x * 73856093u) ^ (k.y * 19349663u) ^ (k.z * 83492791u);
+        }
+    };
+
+    PositionKey key_of(const glm::vec3& p) {
+        PositionKey key;
+        std::memcpy(&key.x, &p.x, 4);
+        std::memcpy(&key.y, &p.y, 4);
+        std::memcpy(&key.z, &p.z, 4);
+        return key;
+    }
+
+    struct Collapse {
+        double cost;
+        GLuint from;
+        GLuint to;
+    };
+
+    constexpr int MAX_PASSES = 64;
+}
+
+std::vector<GLuint> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                             size_t target_index_count, float& out_error) {
+    out_error = 0.0f;
+    const size_t vertex_count = vertices.size();
+
+    // vertices sharing a position (split by UV or normal) form one topological vertex
+    std::vector<GLuint> position_id(vertex_count);
+    std::vector<std::uint32_t> wedges;
+    {
+        std::unordered_map<PositionKey, GLuint, PositionHash> ids;
+        ids.reserve(vertex_count);
+        for (size_t v = 0; v < vertex_count; ++v) {
+            auto [it, inserted] = ids.try_emplace(key_of(vertices[v].m_position), static_cast<GLuint>(ids.size()));
+            position_id[v] = it->second;
+            if (inserted)
+                wedges.push_back(0);
+            ++wedges[it->second];
+        }
+    }
+    const size_t position_count = wedges.size();
+
+    // seams lock, border and non manifold edges lock both ends
+    std::vector<std::uint8_t> locked(position_count, 0);
+    for (size_t p = 0; p < position_count; ++p)
+        locked[p] = wedges[p] > 1;
+    {
+        std::unordered_map<std::uint64_t, std::uint32_t> edges;
+        edges.reserve(indices.size());
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            for (int e = 0; e < 3; ++e) {
+                const std::uint64_t a = position_id[indices[t + e]], b = position_id[indices[t + (e + 1) % 3]];
+                ++edges[std::min(a, b) << 32 | std::max(a, b)];
+            }
+        }
+        for (const auto& [edge, count] : edges) {
+            if (count != 2) {
+                locked[edge >> 32] = 1;
+                locked[edge & 0xFFFFFFFFu] = 1;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(position_count);
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const glm::vec3& p0 = vertices[indices[t]].m_position;
+        const glm::vec3& p1 = vertices[indices[t + 1]].m_position;
+        const glm::vec3& p2 = vertices[indices[t + 2]].m_position;
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(n);
+        if (length <= 0.0f)
+            continue;
+        n /= length;
+        const Quadric q = Quadric::plane(n, -glm::dot(n, p0));
+        for (int c = 0; c < 3; ++c)
+            quadrics[position_id[indices[t + c]]] += q;
+    }
+
+    std::vector<GLuint> current = indices;
+    std::vector<GLuint> collapse_to(vertex_count);
+    std::vector<std::uint8_t> touched(vertex_count);
+    std::vector<std::uint32_t> adjacency_offsets(vertex_count + 1);
+    std::vector<std::uint32_t> adjacency;
+    std::vector<Collapse> candidates;
+    double max_cost = 0.0;
+
+    for (int pass = 0; pass < MAX_PASSES && current.size() > target_index_count; ++pass) {
+        // triangles around every vertex
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+        for (const GLuint v : current)
+            ++adjacency_offsets[v + 1];
+        for (size_t v = 0; v < vertex_count; ++v)
+            adjacency_offsets[v + 1] += adjacency_offsets[v];
+        adjacency.resize(current.size());
+        {
+            std::vector<std::uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (size_t i = 0; i < current.size(); ++i)
+                adjacency[fill[current[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+
+        candidates.clear();
+        for (size_t t = 0; t < current.size(); t += 3) {
+            for (int e = 0; e < 3; ++e) {
+                const GLuint a = current[t + e], b = current[t + (e + 1) % 3];
+                const GLuint pa = position_id[a], pb = position_id[b];
+                Quadric q = quadrics[pa];
+                q += quadrics[pb];
+                if (!locked[pa])
+                    candidates.push_back({q.evaluate(vertices[b].m_position), a, b});
+                if (!locked[pb])
+                    candidates.push_back({q.evaluate(vertices[a].m_position), b, a});
+            }
+        }
+        if (candidates.empty())
+            break;
+        std::ranges::sort(candidates, {}, &Collapse::cost);
+
+        for (size_t v = 0; v < vertex_count; ++v)
+            collapse_to[v] = static_cast<GLuint>(v);
+        std::fill(touched.begin(), touched.end(), 0);
+
+        const size_t excess_triangles = (current.size() - target_index_count) / 3;
+        size_t removed_triangles = 0;
+        size_t collapses = 0;
+
+        for (const Collapse& candidate : candidates) {
+            if (removed_triangles >= excess_triangles)
+                break;
+            const GLuint u = candidate.from, w = candidate.to;
+            if (touched[u] || touched[w])
+                continue;
+
+            // reject collapses that flip a surrounding triangle
+            const glm::vec3& target = vertices[w].m_position;
+            size_t degenerate = 0;
+            bool flips = false;
+            for (std::uint32_t k = adjacency_offsets[u]; k < adjacency_offsets[u + 1] && !flips; ++k) {
+                const GLuint* tri = &current[adjacency[k] * 3];
+                if (tri[0] == w || tri[1] == w || tri[2] == w) {
+                    ++degenerate;
+                    continue;
+                }
+                glm::vec3 p[3], q[3];
+                for (int c = 0; c < 3; ++c) {
+                    p[c] = vertices[tri[c]].m_position;
+                    q[c] = tri[c] == u ? target : p[c];
+                }
+                const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                const glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+            if (flips || degenerate == 0)
+                continue;
+
+            // the whole one ring is frozen for the rest of the pass, keeps the flip test valid
+            for (std::uint32_t k = adjacency_offsets[u]; k < adjacency_offsets[u + 1]; ++k)
+                for (int c = 0; c < 3; ++c)
+                    touched[current[adjacency[k] * 3 + c]] = 1;
+
+            collapse_to[u] = w;
+            quadrics[position_id[w]] += quadrics[position_id[u]];
+            max_cost = std::max(max_cost, candidate.cost);
+            removed_triangles += degenerate;
+            ++collapses;
+        }
+        if (collapses == 0)
+            break;
+
+        size_t out = 0;
+        for (size_t t = 0; t < current.size(); t += 3) {
+            const GLuint a = collapse_to[current[t]], b = collapse_to[current[t + 1]], c = collapse_to[current[t + 2]];
+            const GLuint pa = position_id[a], pb = position_id[b], pc = position_id[c];
+            if (pa == pb || pb == pc || pa == pc)
+                continue;
+            current[out++] = a;
+            current[out++] = b;
+            current[out++] = c;
+        }
+        current.resize(out);
+    }
+
+    out_error = static_cast<float>(std::sqrt(std::max(max_cost, 0.0)));
+    return current;
+}
+
+std::vector<LodLevel> MeshSimplifier::build_lod_chain(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                                      size_t level_count) {
+    std::vector<LodLevel> levels;
+    levels.reserve(level_count); // previous points into it
+    const std::vector<GLuint>* previous = &indices;
+    float previous_error = 0.0f;
+
+    for (size_t level = 1; level <= level_count; ++level) {
+        const size_t target = (indices.size() / 3 >> level) * 3;
+        if (target < 3)
+            break;
+
+        float error = 0.0f;
+        std::vector<GLuint> simplified = simplify(vertices, *previous, target, error);
+        // locked seams and borders can stop the reduction early, such a level is not worth its memory
+        if (simplified.empty() || simplified.size() > previous->size() * 4 / 5)
+            break;
+
+        MeshOptimizer::optimize_vertex_cache(simplified, vertices.size());
+        previous_error += error; // each level is simplified from the previous one
+        levels.push_back({std::move(simplified), previous_error});
+        previous = &levels.back().indices;
+    }
+    return levels;
+}
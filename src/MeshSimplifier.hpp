@@ -0,0 +1,30 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 29.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef MESHSIMPLIFIER_HPP
+#define MESHSIMPLIFIER_HPP
+
+#include <vector>
+#include <GL/glew.h>
+
+#include "MeshData.hpp"
+#include "Vertex.hpp"
+
+// quadric error metric simplification (Garland & Heckbert 1997)
+// - greedy edge collapses in passes, every pass collapses an independent set of cheapest edges
+// - vertices collapse onto a neighbour, so every level indexes the original vertex buffer
+// - UV/normal seams and open borders are locked, they keep their shape at every level
+class MeshSimplifier {
+public:
+    // out_error - largest collapse error, roughly an object space distance
+    static std::vector<GLuint> simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                        size_t target_index_count, float& out_error);
+
+    // levels at 1/2, 1/4, 1/8 of the triangles, stops when a level can not be reduced enough
+    static std::vector<LodLevel> build_lod_chain(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                                 size_t level_count = 3);
+};
+
+#endif //MESHSIMPLIFIER_HPP
@@ -6,86 +6,56 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <limits>
 #include "Model.hpp"
+#include "ResourceManager.hpp"
 
-Model::Model(const std::filesystem::path &filename, ShaderProgram &shader) {
-    std::string outfilename_str = filename.string();
-    const char* outfilename_ptr = outfilename_str.c_str();
-
-    std::vector < glm::vec3 > out_vertices;
-    std::vector < glm::vec2 > out_uvs;
-    std::vector < glm::vec3 > out_normals;
-    std::vector < GLuint > out_indices;
-    loadOBJ(outfilename_ptr, out_vertices, out_uvs, out_normals, out_indices);
-
-    std::vector<Vertex> meshVertices;
-
-    for (size_t i = 0; i < out_vertices.size(); i++) {
-        Vertex vertex{};
-        vertex.m_position = out_vertices[i];
-        vertex.m_normal = out_normals[i];
-        vertex.m_tex_coords = out_uvs[i];
-        meshVertices.push_back(vertex);
-    }
-
-    meshes.emplace_back(std::make_shared<Mesh>(
-        GL_TRIANGLES,
-        shader,
-        meshVertices,
-        out_indices,
-        glm::vec3(0.0f),
-        glm::vec3(0.0f)
-    ));
-}
+Model::Model(const std::filesystem::path &filename, ShaderProgram &shader)
+    : Model(filename, shader, std::filesystem::path{}) {}
 
 Model::Model(const std::filesystem::path& filename, ShaderProgram& shader, const std::filesystem::path& texture_file_path) {//WITH TEXTURE
-    std::string outfilename_str = filename.string();
-    const char* outfilename_ptr = outfilename_str.c_str();
-
-    std::vector < glm::vec3 > out_vertices;
-    std::vector < glm::vec2 > out_uvs;
-    std::vector < glm::vec3 > out_normals;
-    std::vector < GLuint > out_indices;
-    loadOBJ(outfilename_ptr, out_vertices, out_uvs, out_normals, out_indices);
-
-    std::vector<Vertex> meshVertices;
-
-    for (size_t i = 0; i < out_vertices.size(); i++) {
-        Vertex vertex{};
-        vertex.m_position = out_vertices[i];
-        vertex.m_normal = out_normals[i];
-        vertex.m_tex_coords = out_uvs[i];
-        meshVertices.push_back(vertex);
+    // repeated files are parsed and optimized once, textures decoded and uploaded once
+    const MeshResource source = ResourceManager::load_mesh(filename);
+    const MeshData& data = ResourceManager::mesh(source);
+
+    TextureResource texture;
+    if (!texture_file_path.empty()) {
+        texture = ResourceManager::load_texture(texture_file_path);
+        tex_ID = ResourceManager::texture(texture);
     }
 
-    GLuint texture_id = textureInit(texture_file_path.string().c_str());
-
     meshes.emplace_back(std::make_shared<Mesh>(
         GL_TRIANGLES,
         shader,
-        meshVertices,
-        out_indices,
+        data,
         glm::vec3(0.0f),
         glm::vec3(0.0f),
-        texture_id
+        tex_ID
     ));
+    meshes.back()->mesh_resource = source;
+    meshes.back()->texture_resource = texture;
+    update_bounds();
 }
 
-void Model::draw(glm::vec3 const &offset, glm::vec3 const &rotation, glm::vec3 const &scale_change) {
-    // compute complete transformation
+glm::mat4 Model::get_model_matrix() const {
     glm::mat4 t = glm::translate(glm::mat4(1.0f), m_origin);
     glm::mat4 rx = glm::rotate(glm::mat4(1.0f), orientation.x, glm::vec3(1.0f, 0.0f, 0.0f));
     glm::mat4 ry = glm::rotate(glm::mat4(1.0f), orientation.y, glm::vec3(0.0f, 1.0f, 0.0f));
     glm::mat4 rz = glm::rotate(glm::mat4(1.0f), orientation.z, glm::vec3(0.0f, 0.0f, 1.0f));
     glm::mat4 s = glm::scale(glm::mat4(1.0f), scale);
 
+    return local_model_matrix * s * rz * ry * rx * t;
+}
+
+void Model::draw(glm::vec3 const &offset, glm::vec3 const &rotation, glm::vec3 const &scale_change) {
+    // compute complete transformation
     glm::mat4 m_off = glm::translate(glm::mat4(1.0f), offset);
     glm::mat4 m_rx = glm::rotate(glm::mat4(1.0f), rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
     glm::mat4 m_ry = glm::rotate(glm::mat4(1.0f), rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
     glm::mat4 m_rz = glm::rotate(glm::mat4(1.0f), rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
     glm::mat4 m_s = glm::scale(glm::mat4(1.0f), scale_change);
 
-    glm::mat4 model_matrix = local_model_matrix * s * rz * ry * rx * t * m_s * m_rz * m_ry * m_rx * m_off;
+    glm::mat4 model_matrix = get_model_matrix() * m_s * m_rz * m_ry * m_rx * m_off;
 
     // draw all meshes
     for (auto mesh : meshes) {
@@ -98,3 +68,31 @@ void Model::draw(glm::mat4 const &model_matrix) {
         mesh->draw(local_model_matrix * model_matrix);
     }
 }
+
+void Model::update_bounds() {
+    bounds_min = glm::vec3(std::numeric_limits<float>::max());
+    bounds_max = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const auto& mesh : meshes) {
+        if (mesh->vertices.empty())
+            continue;
+        bounds_min = glm::min(bounds_min, mesh->bounds_min);
+        bounds_max = glm::max(bounds_max, mesh->bounds_max);
+    }
+    if (bounds_min.x > bounds_max.x)
+        bounds_min = bounds_max = glm::vec3(0.0f);
+}
+
+void Model::get_world_bounds(glm::vec3& out_min, glm::vec3& out_max) const {
+    // Arvo: transformed extent is |M| * extent
+    const glm::mat4 m = get_model_matrix();
+    const glm::vec3 center = glm::vec3(m * glm::vec4((bounds_min + bounds_max) * 0.5f, 1.0f));
+    const glm::vec3 extent = (bounds_max - bounds_min) * 0.5f;
+
+    glm::vec3 world_extent(0.0f);
+    for (int col = 0; col < 3; ++col)
+        for (int row = 0; row < 3; ++row)
+            world_extent[row] += std::abs(m[col][row]) * extent[col];
+
+    out_min = center - world_extent;
+    out_max = center + world_extent;
+}
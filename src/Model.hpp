@@ -32,6 +32,11 @@ public:
     GLuint tex_ID = 0;  // Texture ID for model
 
     bool transparent = false ;
+    bool dynamic = false; // transformation changes at runtime
+
+    // local space bounds of all meshes
+    glm::vec3 bounds_min{0.0f};
+    glm::vec3 bounds_max{0.0f};
 
 	Model() = default;
 
@@ -47,6 +52,14 @@ public:
 
     void draw(glm::mat4 const& model_matrix);
 
+    // complete transformation from origin, orientation and scale
+    glm::mat4 get_model_matrix() const;
+
+    // recompute local bounds, call after meshes change
+    void update_bounds();
+
+    // world space AABB enclosing the transformed local bounds
+    void get_world_bounds(glm::vec3& out_min, glm::vec3& out_max) const;
 
     
 
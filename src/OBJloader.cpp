@@ -1,109 +1,372 @@
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <string>
-#include <GL/glew.h> 
+#include <thread>
 #include <glm/glm.hpp>
-#include <unordered_map>
-#include <tuple>
+
 #include "OBJloader.hpp"
-#include <cstring>
-#include <functional>
+#include "Logger.hpp"
+#include "MappedFile.hpp"
+
+namespace {
+    constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+    constexpr std::uint32_t FIRST = 0x80000000u; // welded id of the corner that created the vertex
+    constexpr size_t MIN_CHUNK = 256 * 1024;
+
+    // 0 based indices into the whole file, NONE = not given
+    struct Corner {
+        std::uint32_t v = NONE, t = NONE, n = NONE;
+        bool operator==(const Corner&) const = default;
+    };
+
+    struct Counts {
+        size_t v = 0, t = 0, n = 0, f = 0;
+    };
+
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        Counts base;  // elements defined before this chunk, resolves negative indices
+        Counts count; // elements defined in this chunk
+        std::vector<glm::vec3> positions, normals;
+        std::vector<glm::vec2> uvs;
+        std::vector<Corner> corners; // 3 per triangle
+        std::string error;
 
-#define MAX_LINE_SIZE 255
+        // weld results
+        std::vector<std::uint32_t> welded; // per corner, id in the weld table of its position range (| FIRST)
+        size_t first_vertex = 0;           // output vertices created by earlier chunks
+        size_t first_index = 0;
+        size_t vertex_count = 0;
+        std::vector<std::uint32_t> missing_normals; // vertices of corners without vn
+    };
 
-// Custom hash function for a tuple of three unsigned ints
-struct TupleHash {
-    size_t operator()(const std::tuple<unsigned int, unsigned int, unsigned int>& t) const {
-        auto [a, b, c] = t;
-        return std::hash<unsigned int>()(a) ^
-               (std::hash<unsigned int>()(b) << 1) ^
-               (std::hash<unsigned int>()(c) << 2);
+    bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    const char* skip_spaces(const char* p, const char* end) {
+        while (p < end && is_space(*p))
+            ++p;
+        return p;
     }
-};
 
-bool loadOBJ(const char* path, std::vector<glm::vec3>& out_vertices, std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals, std::vector<GLuint>& out_indices) {
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_uvs;
-    std::vector<glm::vec3> temp_normals;
+    // p past the keyword if the line starts with it, else nullptr
+    const char* keyword(const char* p, const char* end, std::string_view word) {
+        if (static_cast<size_t>(end - p) <= word.size() || std::memcmp(p, word.data(), word.size()) != 0 || !is_space(p[word.size()]))
+            return nullptr;
+        return p + word.size();
+    }
 
-    // (position index, uv index, normal index)
-    std::unordered_map<std::tuple<unsigned int, unsigned int, unsigned int>, GLuint, TupleHash> uniqueVertexMap;
+    bool parse_float(const char*& p, const char* end, float& value) {
+        p = skip_spaces(p, end);
+        if (p < end && *p == '+')
+            ++p; // from_chars rejects an explicit plus
+        const auto [next, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc())
+            return false;
+        p = next;
+        return true;
+    }
 
-    out_vertices.clear();
-    out_uvs.clear();
-    out_normals.clear();
-    out_indices.clear();
+    // 1 based or negative (relative to the elements defined so far) -> 0 based
+    bool parse_index(const char*& p, const char* end, size_t defined, std::uint32_t& index) {
+        long long value = 0;
+        const auto [next, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc() || value == 0)
+            return false;
+        p = next;
+        const long long resolved = value > 0 ? value - 1 : static_cast<long long>(defined) + value;
+        if (resolved < 0 || resolved >= NONE)
+            return false;
+        index = static_cast<std::uint32_t>(resolved);
+        return true;
+    }
 
-    FILE* file = fopen(path, "r");
-    if (file == NULL) {
-        printf("Impossible to open the file !\n");
-        return false;
+    const char* line_end(const char* p, const char* end) {
+        const auto* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        return newline ? newline : end;
     }
 
-    while (1) {
-        char lineHeader[MAX_LINE_SIZE];
-        int res = fscanf(file, "%s", lineHeader, MAX_LINE_SIZE);
-        if (res == EOF) {
-            break;
+    // first pass, only the element counts - negative indices of later chunks need them, reserve the rest
+    void count(Chunk& chunk) {
+        for (const char* p = chunk.begin; p < chunk.end;) {
+            const char* eol = line_end(p, chunk.end);
+            p = skip_spaces(p, eol);
+            if (keyword(p, eol, "v"))
+                ++chunk.count.v;
+            else if (keyword(p, eol, "vt"))
+                ++chunk.count.t;
+            else if (keyword(p, eol, "vn"))
+                ++chunk.count.n;
+            else if (keyword(p, eol, "f"))
+                ++chunk.count.f;
+            p = eol + 1;
         }
+    }
 
-        if (strcmp(lineHeader, "v") == 0) {
-            glm::vec3 vertex;
-            fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
-            temp_vertices.push_back(vertex);
+    void parse(Chunk& chunk) {
+        chunk.positions.reserve(chunk.count.v);
+        chunk.uvs.reserve(chunk.count.t);
+        chunk.normals.reserve(chunk.count.n);
+        chunk.corners.reserve(chunk.count.f * 3); // exact for triangles
+        std::vector<Corner> polygon;
+        size_t line = 0;
+
+        const auto fail = [&](const char* what) {
+            chunk.error = std::string(what) + " (line " + std::to_string(line) + " of chunk)";
+        };
+
+        for (const char *p = chunk.begin, *eol; p < chunk.end; p = eol + 1) {
+            ++line;
+            eol = line_end(p, chunk.end);
+            p = skip_spaces(p, eol);
+            if (const char* q = keyword(p, eol, "v")) {
+                glm::vec3 position;
+                if (!parse_float(q, eol, position.x) || !parse_float(q, eol, position.y) || !parse_float(q, eol, position.z))
+                    return fail("invalid v");
+                chunk.positions.push_back(position);
+            } else if (const char* q = keyword(p, eol, "vt")) {
+                glm::vec2 uv;
+                if (!parse_float(q, eol, uv.y) || !parse_float(q, eol, uv.x))
+                    return fail("invalid vt");
+                chunk.uvs.push_back(uv);
+            } else if (const char* q = keyword(p, eol, "vn")) {
+                glm::vec3 normal;
+                if (!parse_float(q, eol, normal.x) || !parse_float(q, eol, normal.y) || !parse_float(q, eol, normal.z))
+                    return fail("invalid vn");
+                chunk.normals.push_back(normal);
+            } else if (const char* q = keyword(p, eol, "f")) {
+                // v, v/vt, v//vn or v/vt/vn per corner
+                polygon.clear();
+                for (q = skip_spaces(q, eol); q < eol; q = skip_spaces(q, eol)) {
+                    Corner corner;
+                    if (!parse_index(q, eol, chunk.base.v + chunk.positions.size(), corner.v))
+                        return fail("invalid face index");
+                    if (q < eol && *q == '/') {
+                        ++q;
+                        if (q < eol && *q != '/' && !parse_index(q, eol, chunk.base.t + chunk.uvs.size(), corner.t))
+                            return fail("invalid face uv index");
+                        if (q < eol && *q == '/') {
+                            ++q;
+                            if (!parse_index(q, eol, chunk.base.n + chunk.normals.size(), corner.n))
+                                return fail("invalid face normal index");
+                        }
+                    }
+                    polygon.push_back(corner);
+                }
+                if (polygon.size() < 3)
+                    return fail("face with less than 3 corners");
+                for (size_t i = 1; i + 1 < polygon.size(); ++i)
+                    chunk.corners.insert(chunk.corners.end(), {polygon[0], polygon[i], polygon[i + 1]});
+            }
+            // o, g, s, usemtl, mtllib, comments... ignored
         }
-        else if (strcmp(lineHeader, "vt") == 0) {
-            glm::vec2 uv;
-            fscanf(file, "%f %f\n", &uv.y, &uv.x);
-            temp_uvs.push_back(uv);
+    }
+
+    // f(0 .. count - 1), one thread each, the calling thread takes 0
+    template <typename F>
+    void parallel_for(size_t count, const F& f) {
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < count; ++i)
+            threads.emplace_back([&, i] { f(i); });
+        f(0);
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    template <typename F>
+    void for_each_chunk(std::vector<Chunk>& chunks, const F& f) {
+        parallel_for(chunks.size(), [&](size_t i) { f(chunks[i]); });
+    }
+
+    // open addressing, linear probing - (v, vt, vn) -> output vertex
+    // slots follow the position index, exporters write faces in roughly vertex order so probes stay in cache
+    class WeldTable {
+    public:
+        explicit WeldTable(size_t positions)
+            : m_slots(std::bit_ceil(std::max<size_t>(positions * 4, 64))), m_mask(m_slots.size() - 1) {}
+
+        // existing vertex, or NONE after storing key -> next
+        std::uint32_t insert(const Corner& key, std::uint32_t next) {
+            if (2 * (m_size + 1) > m_slots.size())
+                grow();
+            for (size_t i = slot_of(key);; i = (i + 1) & m_mask) {
+                Slot& slot = m_slots[i];
+                if (slot.index == NONE) {
+                    slot = {key, next};
+                    ++m_size;
+                    return NONE;
+                }
+                if (slot.key == key)
+                    return slot.index;
+            }
         }
-        else if (strcmp(lineHeader, "vn") == 0) {
-            glm::vec3 normal;
-            fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
-            temp_normals.push_back(normal);
+
+    private:
+        struct Slot {
+            Corner key;
+            std::uint32_t index = NONE;
+        };
+
+        size_t slot_of(const Corner& c) const {
+            // variants of one position (uv / normal seams) land next to each other
+            const std::uint32_t variant = (c.t * 0x9E3779B1u ^ c.n * 0x85EBCA77u) >> 30;
+            return (static_cast<size_t>(c.v) * 4 + variant) & m_mask;
         }
-        else if (strcmp(lineHeader, "f") == 0) {
-            unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-            int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n",
-                &vertexIndex[0], &uvIndex[0], &normalIndex[0],
-                &vertexIndex[1], &uvIndex[1], &normalIndex[1],
-                &vertexIndex[2], &uvIndex[2], &normalIndex[2]);
-
-            if (matches != 9) {
-                printf("File can't be read by simple parser :( Try exporting with other options\n");
-                fclose(file);
-                return false;
+
+        void grow() {
+            std::vector<Slot> old(m_slots.size() * 2);
+            old.swap(m_slots);
+            m_mask = m_slots.size() - 1;
+            for (const Slot& slot : old) {
+                if (slot.index == NONE)
+                    continue;
+                size_t i = slot_of(slot.key);
+                while (m_slots[i].index != NONE)
+                    i = (i + 1) & m_mask;
+                m_slots[i] = slot;
             }
+        }
 
-            for (int i = 0; i < 3; i++) {
-                // Adjust indices (OBJ is 1-based, our arrays are 0-based)
-                unsigned int vI = vertexIndex[i] - 1;
-                unsigned int uvI = uvIndex[i] - 1;
-                unsigned int nI = normalIndex[i] - 1;
-
-                // Create a tuple of position, uv, and normal indices
-                auto vertexKey = std::make_tuple(vI, uvI, nI);
-
-                // Check if we've seen this vertex combination before
-                auto it = uniqueVertexMap.find(vertexKey);
-                if (it == uniqueVertexMap.end()) {
-                    // Add this unique vertex to our output arrays
-                    GLuint newIndex = static_cast<GLuint>(out_vertices.size());
-                    uniqueVertexMap[vertexKey] = newIndex;
-
-                    // Add the vertex data
-                    out_vertices.push_back(temp_vertices[vI]);
-                    out_uvs.push_back(temp_uvs[uvI]);
-                    out_normals.push_back(temp_normals[nI]);
-
-                    // Add the index
-                    out_indices.push_back(newIndex);
-                } else {
-                    // Reuse the existing vertex
-                    out_indices.push_back(it->second);
-                }
+        std::vector<Slot> m_slots;
+        size_t m_mask;
+        size_t m_size = 0;
+    };
+}
+
+bool loadOBJ(const std::filesystem::path& path, std::vector<Vertex>& out_vertices, std::vector<GLuint>& out_indices) {
+    out_vertices.clear();
+    out_indices.clear();
+
+    const MappedFile file(path);
+    const char* const data = file.data();
+    const char* const end = data + file.size();
+
+    // line aligned chunks, one per hardware thread for large files
+    const size_t threads = std::clamp<size_t>(file.size() / MIN_CHUNK, 1, std::max(std::thread::hardware_concurrency(), 1u));
+    std::vector<Chunk> chunks(threads);
+    const char* p = data;
+    for (size_t i = 0; i < threads; ++i) {
+        chunks[i].begin = p;
+        if (i + 1 < threads && p < end) {
+            p = std::min(data + file.size() / threads * (i + 1), end);
+            p = std::min(line_end(std::max(p, chunks[i].begin), end) + 1, end);
+        } else {
+            p = end;
+        }
+        chunks[i].end = p;
+    }
+
+    for_each_chunk(chunks, count);
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        chunks[i].base.v = chunks[i - 1].base.v + chunks[i - 1].count.v;
+        chunks[i].base.t = chunks[i - 1].base.t + chunks[i - 1].count.t;
+        chunks[i].base.n = chunks[i - 1].base.n + chunks[i - 1].count.n;
+    }
+    for_each_chunk(chunks, parse);
+
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> uvs;
+    size_t corner_count = 0;
+    for (Chunk& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            Logger::error("OBJ " + path.string() + ": " + chunk.error);
+            return false;
+        }
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        corner_count += chunk.corners.size();
+    }
+
+    for_each_chunk(chunks, [&](Chunk& chunk) {
+        for (const Corner& corner : chunk.corners)
+            if (corner.v >= positions.size() || (corner.t != NONE && corner.t >= uvs.size()) || (corner.n != NONE && corner.n >= normals.size()))
+                return void(chunk.error = "face index out of range");
+    });
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            Logger::error("OBJ " + path.string() + ": " + chunk.error);
+            return false;
+        }
+    }
+
+    // weld, output order = first use like the exporter wrote it
+    // - corners only weld with corners of the same position, one table per position range and thread,
+    //   every thread walks all corners in file order and takes those of its range
+    // - table ids follow first use as well, the output vertex of a first use is the number of first uses before it
+    const size_t ranges = chunks.size();
+    const size_t range_size = positions.size() / ranges + 1;
+    std::vector<std::vector<std::uint32_t>> range_vertices(ranges); // table id -> output vertex
+    for (Chunk& chunk : chunks)
+        chunk.welded.resize(chunk.corners.size());
+    parallel_for(ranges, [&](size_t range) {
+        const size_t first = range * range_size;
+        const size_t last = std::min(first + range_size, positions.size());
+        WeldTable table(last > first ? last - first : 0);
+        std::uint32_t next = 0;
+        for (Chunk& chunk : chunks) {
+            for (size_t i = 0; i < chunk.corners.size(); ++i) {
+                const Corner& corner = chunk.corners[i];
+                if (corner.v < first || corner.v >= last)
+                    continue;
+                const std::uint32_t existing = table.insert(corner, next);
+                chunk.welded[i] = existing != NONE ? existing : next++ | FIRST;
             }
         }
+        range_vertices[range].resize(next);
+    });
+
+    for_each_chunk(chunks, [](Chunk& chunk) {
+        chunk.vertex_count = static_cast<size_t>(std::ranges::count_if(chunk.welded, [](std::uint32_t id) { return (id & FIRST) != 0; }));
+    });
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        chunks[i].first_vertex = chunks[i - 1].first_vertex + chunks[i - 1].vertex_count;
+        chunks[i].first_index = chunks[i - 1].first_index + chunks[i - 1].corners.size();
     }
+    out_vertices.resize(chunks.back().first_vertex + chunks.back().vertex_count);
+    out_indices.resize(corner_count);
 
-    fclose(file);
+    // vertices first, corners of a later chunk may use a vertex created by an earlier one
+    for_each_chunk(chunks, [&](Chunk& chunk) {
+        auto vertex = static_cast<std::uint32_t>(chunk.first_vertex);
+        for (size_t i = 0; i < chunk.corners.size(); ++i) {
+            if ((chunk.welded[i] & FIRST) == 0)
+                continue;
+            const Corner& corner = chunk.corners[i];
+            range_vertices[corner.v / range_size][chunk.welded[i] & ~FIRST] = vertex;
+            out_vertices[vertex] = {positions[corner.v],
+                                    corner.n != NONE ? normals[corner.n] : glm::vec3(0.0f),
+                                    corner.t != NONE ? uvs[corner.t] : glm::vec2(0.0f)};
+            if (corner.n == NONE)
+                chunk.missing_normals.push_back(vertex);
+            ++vertex;
+        }
+    });
+    for_each_chunk(chunks, [&](Chunk& chunk) {
+        for (size_t i = 0; i < chunk.corners.size(); ++i)
+            out_indices[chunk.first_index + i] = range_vertices[chunk.corners[i].v / range_size][chunk.welded[i] & ~FIRST];
+    });
+
+    std::vector<std::uint32_t> missing_normals; // in vertex order, chunks create ascending vertices
+    for (const Chunk& chunk : chunks)
+        missing_normals.insert(missing_normals.end(), chunk.missing_normals.begin(), chunk.missing_normals.end());
+
+    // area weighted face normals for corners without vn, welded corners share them
+    if (!missing_normals.empty()) {
+        std::vector<glm::vec3> accumulated(out_vertices.size(), glm::vec3(0.0f));
+        for (size_t i = 0; i + 2 < out_indices.size(); i += 3) {
+            const glm::vec3& a = out_vertices[out_indices[i]].m_position;
+            const glm::vec3 face = glm::cross(out_vertices[out_indices[i + 1]].m_position - a, out_vertices[out_indices[i + 2]].m_position - a);
+            for (size_t k = 0; k < 3; ++k)
+                accumulated[out_indices[i + k]] += face;
+        }
+        for (const std::uint32_t i : missing_normals) {
+            const float length = glm::length(accumulated[i]);
+            out_vertices[i].m_normal = length > 0.0f ? accumulated[i] / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
     return true;
-}
\ No newline at end of file
+}
@@ -2,15 +2,18 @@
 #ifndef OBJloader_H
 #define OBJloader_H
 
+#include <filesystem>
 #include <vector>
-#include <glm/fwd.hpp>
+#include <GL/glew.h>
 
-bool loadOBJ(
-	const char * path,
-	std::vector <glm::vec3>& out_vertices,
-	std::vector <glm::vec2>& out_uvs,
-	std::vector <glm::vec3>& out_normals,
-	std::vector<GLuint>& out_indices
-);
+#include "Vertex.hpp"
+
+// Wavefront OBJ -> indexed triangle list
+// - file is memory mapped and split into line aligned chunks, parsed in parallel with std::from_chars
+// - v / vt / vn, faces with any number of corners (fan triangulated), negative (relative) indices
+// - corners without vt get uv 0, corners without vn a smoothed face normal
+// - vertices welded by their (v, vt, vn) triple in order of first use
+// - vt is read as (v, u), the bundled assets depend on it
+bool loadOBJ(const std::filesystem::path& path, std::vector<Vertex>& out_vertices, std::vector<GLuint>& out_indices);
 
 #endif
@@ -0,0 +1,104 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 27.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include "OitPass.hpp"
+#include "GLState.hpp"
+#include "Logger.hpp"
+
+OitPass::OitPass()
+    : m_composite_program(ResourceManager::load_program("shaders/oit_composite.vert", "shaders/oit_composite.frag")) {
+    glCreateVertexArrays(1, &m_empty_vao);
+    ShaderProgram& program = ResourceManager::program(m_composite_program);
+    program.setUniform("uAccum"_u, 0);
+    program.setUniform("uRevealage"_u, 1);
+}
+
+void OitPass::resize(int width, int height) {
+    if (width <= 0 || height <= 0)
+        return; // minimised window, the old targets stay until it has a size again
+
+    if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
+    if (m_accum) glDeleteTextures(1, &m_accum);
+    if (m_revealage) glDeleteTextures(1, &m_revealage);
+    if (m_depth) glDeleteTextures(1, &m_depth);
+    GLState::invalidate();
+
+    m_width = width;
+    m_height = height;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_accum);
+    glTextureStorage2D(m_accum, 1, GL_RGBA16F, width, height);
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_revealage);
+    glTextureStorage2D(m_revealage, 1, GL_R8, width, height);
+    // must match default framebuffer depth format for blit
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_depth);
+    glTextureStorage2D(m_depth, 1, GL_DEPTH24_STENCIL8, width, height);
+
+    for (GLuint texture : {m_accum, m_revealage, m_depth}) {
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    glCreateFramebuffers(1, &m_fbo);
+    glNamedFramebufferTexture(m_fbo, GL_COLOR_ATTACHMENT0, m_accum, 0);
+    glNamedFramebufferTexture(m_fbo, GL_COLOR_ATTACHMENT1, m_revealage, 0);
+    glNamedFramebufferTexture(m_fbo, GL_DEPTH_STENCIL_ATTACHMENT, m_depth, 0);
+    const GLenum draw_buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glNamedFramebufferDrawBuffers(m_fbo, 2, draw_buffers);
+
+    if (glCheckNamedFramebufferStatus(m_fbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        Logger::error("OIT framebuffer incomplete");
+}
+
+void OitPass::begin(int width, int height) {
+    if (width != m_width || height != m_height)
+        resize(width, height);
+
+    // transparent surfaces are hidden by opaque ones, but never write depth
+    glBlitNamedFramebuffer(0, m_fbo, 0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    const GLfloat accum_clear[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat revealage_clear[] = {1.0f, 0.0f, 0.0f, 0.0f};
+    glClearNamedFramebufferfv(m_fbo, GL_COLOR, 0, accum_clear);
+    glClearNamedFramebufferfv(m_fbo, GL_COLOR, 1, revealage_clear);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glEnable(GL_BLEND);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    glDepthMask(GL_FALSE);
+}
+
+void OitPass::end() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OitPass::composite() {
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+    ResourceManager::program(m_composite_program).activate();
+    GLState::bind_texture(0, m_accum);
+    GLState::bind_texture(1, m_revealage);
+    GLState::bind_vertex_array(m_empty_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void OitPass::clear() {
+    if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
+    if (m_accum) glDeleteTextures(1, &m_accum);
+    if (m_revealage) glDeleteTextures(1, &m_revealage);
+    if (m_depth) glDeleteTextures(1, &m_depth);
+    if (m_empty_vao) glDeleteVertexArrays(1, &m_empty_vao);
+    m_fbo = m_accum = m_revealage = m_depth = m_empty_vao = 0;
+    m_width = m_height = 0;
+    ResourceManager::release(m_composite_program);
+    m_composite_program = {};
+    GLState::invalidate();
+}
@@ -0,0 +1,42 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 27.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef OITPASS_HPP
+#define OITPASS_HPP
+
+#include <GL/glew.h>
+
+#include "ResourceManager.hpp"
+
+// weighted blended order independent transparency (McGuire & Bavoil 2013)
+// - transparent geometry is drawn in any order into accumulation (RGBA16F) + revealage (R8) targets,
+//   depth tested against a copy of the opaque depth buffer
+// - composite() blends the resolved color over the default framebuffer
+class OitPass {
+public:
+    OitPass();
+
+    void begin(int width, int height); // bind targets, clear, set blending - draw transparent geometry after
+    void end();                         // back to default framebuffer
+    void composite();                   // resolve over the opaque image
+
+    void clear(); // deallocate GL objects - dont put in destructor
+
+private:
+    void resize(int width, int height);
+
+    ProgramResource m_composite_program;
+
+    GLuint m_fbo{0};
+    GLuint m_accum{0};
+    GLuint m_revealage{0};
+    GLuint m_depth{0};
+    GLuint m_empty_vao{0}; // fullscreen triangle is generated from gl_VertexID
+
+    int m_width{0};
+    int m_height{0};
+};
+
+#endif //OITPASS_HPP
@@ -0,0 +1,72 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 25.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <array>
+
+#include "RenderQueue.hpp"
+
+void RenderQueue::clear() {
+    m_items.clear();
+    m_entries.clear();
+}
+
+std::uint64_t RenderQueue::make_key(RenderPass pass, GLuint program, GLuint texture, GLuint vao, float depth) {
+    constexpr std::uint64_t depth_max = (1u << 24) - 1;
+    const auto quantized = static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>(depth_max));
+
+    // GL names are small integers, collisions after masking only cost a few extra binds
+    const std::uint64_t state = (static_cast<std::uint64_t>(program & 0x3FF) << 28)
+                              | (static_cast<std::uint64_t>(texture & 0x3FFF) << 14)
+                              | static_cast<std::uint64_t>(vao & 0x3FFF);
+    const std::uint64_t pass_bits = static_cast<std::uint64_t>(pass) << 62;
+
+    if (pass == RenderPass::Transparent)
+        return pass_bits | ((depth_max - quantized) << 38) | state;
+    return pass_bits | (state << 24) | quantized;
+}
+
+void RenderQueue::push(RenderPass pass, Mesh* mesh, const glm::mat4& model_matrix, const glm::mat3& normal_matrix,
+                       float depth, float tex_scale, std::uint8_t lod) {
+    const auto item = static_cast<std::uint32_t>(m_items.size());
+    m_items.push_back({mesh, model_matrix, normal_matrix, tex_scale, lod});
+    m_entries.push_back({make_key(pass, mesh->shader.ID, mesh->bound_texture(), mesh->vao(), depth), item});
+}
+
+void RenderQueue::sort() {
+    const size_t n = m_entries.size();
+    m_scratch.resize(n);
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::array<size_t, 256> count{};
+        for (const auto& entry : m_entries)
+            ++count[(entry.key >> shift) & 0xFF];
+
+        // all keys share this byte, nothing to reorder
+        if (count[(m_entries.empty() ? 0 : (m_entries[0].key >> shift) & 0xFF)] == n)
+            continue;
+
+        size_t offset = 0;
+        for (auto& c : count) {
+            const size_t bucket = c;
+            c = offset;
+            offset += bucket;
+        }
+        for (const auto& entry : m_entries)
+            m_scratch[count[(entry.key >> shift) & 0xFF]++] = entry;
+        m_entries.swap(m_scratch);
+    }
+}
+
+void RenderQueue::execute(RenderPass pass) {
+    for (const auto& entry : m_entries) {
+        if (static_cast<RenderPass>(entry.key >> 62) != pass)
+            continue;
+
+        const DrawItem& item = m_items[entry.item];
+        item.mesh->shader.setUniform("tex_scale"_u, item.tex_scale);
+        item.mesh->draw(item.model_matrix, item.normal_matrix, item.lod);
+    }
+}
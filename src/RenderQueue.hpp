@@ -0,0 +1,61 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 25.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+
+enum class RenderPass : std::uint8_t {
+    Opaque = 0,
+    Transparent = 1,
+};
+
+// per frame list of draws, sorted by a 64 bit key before submission
+//   opaque:      | pass:2 | program:10 | texture:14 | vao:14 | depth:24 |  state first, then front to back
+//   transparent: | pass:2 | depth:24 (inverted) | program:10 | texture:14 | vao:14 |  back to front
+// the material is fully described by the bound texture (material constants are shared),
+// meshes from the MaterialTextures table have none and sort together
+class RenderQueue {
+public:
+    struct DrawItem {
+        Mesh* mesh;
+        glm::mat4 model_matrix;
+        glm::mat3 normal_matrix;
+        float tex_scale;
+        std::uint8_t lod;
+    };
+
+    void clear();
+
+    // depth = view distance normalized to [0, 1]
+    void push(RenderPass pass, Mesh* mesh, const glm::mat4& model_matrix, const glm::mat3& normal_matrix,
+              float depth, float tex_scale = 1.0f, std::uint8_t lod = 0);
+
+    void sort(); // LSD radix sort of keys, 8 bits per pass
+
+    void execute(RenderPass pass); // draws all items of the pass in key order, call sort() first
+
+    size_t size() const noexcept { return m_items.size(); }
+
+    static std::uint64_t make_key(RenderPass pass, GLuint program, GLuint texture, GLuint vao, float depth);
+
+private:
+    struct SortEntry {
+        std::uint64_t key;
+        std::uint32_t item;
+    };
+
+    std::vector<DrawItem> m_items;
+    std::vector<SortEntry> m_entries;
+    std::vector<SortEntry> m_scratch;
+};
+
+#endif //RENDERQUEUE_HPP
@@ -0,0 +1,363 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 30.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ResourceManager.hpp"
+#include "Logger.hpp"
+#include "MappedFile.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "OBJloader.hpp"
+#include "TextureBaker.hpp"
+#include "TextureStreamer.hpp"
+
+std::uint64_t ResourceManager::hash(const void* data, size_t size, std::uint64_t h) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+namespace {
+    std::vector<unsigned char> read_file(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            throw std::runtime_error("Resource not found: " + path.string());
+        std::vector<unsigned char> bytes(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return bytes;
+    }
+
+    // canonical path + contents, chained for multi file resources
+    std::uint64_t file_key(const std::filesystem::path& path, const void* data, size_t size, std::uint64_t h = 14695981039346656037ull) {
+        const std::string canonical = std::filesystem::weakly_canonical(path).generic_string();
+        h = ResourceManager::hash(canonical.data(), canonical.size(), h);
+        return ResourceManager::hash(data, size, h);
+    }
+
+    std::uint64_t file_key(const std::filesystem::path& path, const std::vector<unsigned char>& bytes, std::uint64_t h = 14695981039346656037ull) {
+        return file_key(path, bytes.data(), bytes.size(), h);
+    }
+
+    // meshes are only hashed, mapping skips the copy into a buffer
+    std::uint64_t mesh_key(const std::filesystem::path& path) {
+        const MappedFile file(path);
+        return file_key(path, file.data(), file.size());
+    }
+
+    template <typename T>
+    struct Pool {
+        struct Entry {
+            T value{};
+            std::uint64_t key = 0;
+            std::uint32_t refs = 0;
+            std::uint32_t generation = 0;
+            std::string name;
+        };
+
+        std::vector<Entry> entries;
+        std::vector<std::uint32_t> free_slots;
+        std::unordered_map<std::uint64_t, std::uint32_t> lookup;
+        ResourceManager::Stats stats;
+
+        template <typename Handle>
+        Entry* find(Handle handle) {
+            if (handle.slot >= entries.size())
+                return nullptr;
+            Entry& entry = entries[handle.slot];
+            return entry.refs > 0 && entry.generation == handle.generation ? &entry : nullptr;
+        }
+
+        template <typename Handle>
+        bool acquire(std::uint64_t key, Handle& out) {
+            const auto it = lookup.find(key);
+            if (it == lookup.end()) {
+                ++stats.misses;
+                return false;
+            }
+            Entry& entry = entries[it->second];
+            ++entry.refs;
+            ++stats.hits;
+            out = {it->second, entry.generation};
+            return true;
+        }
+
+        template <typename Handle>
+        Handle insert(std::uint64_t key, T value, std::string name) {
+            std::uint32_t slot;
+            if (!free_slots.empty()) {
+                slot = free_slots.back();
+                free_slots.pop_back();
+            } else {
+                slot = static_cast<std::uint32_t>(entries.size());
+                entries.emplace_back();
+            }
+            Entry& entry = entries[slot];
+            entry.value = std::move(value);
+            entry.key = key;
+            entry.refs = 1;
+            entry.name = std::move(name);
+            lookup[key] = slot;
+            ++stats.live;
+            return {slot, entry.generation};
+        }
+
+        template <typename Handle, typename Free>
+        void release(Handle handle, Free&& free) {
+            Entry* entry = find(handle);
+            if (!entry || --entry->refs > 0)
+                return;
+            free(entry->value);
+            entry->value = T{};
+            lookup.erase(entry->key);
+            ++entry->generation;
+            free_slots.push_back(handle.slot);
+            --stats.live;
+        }
+
+        template <typename Free>
+        size_t clear(Free&& free) {
+            size_t leaked = 0;
+            free_slots.clear();
+            for (std::uint32_t slot = 0; slot < entries.size(); ++slot) {
+                Entry& entry = entries[slot];
+                if (entry.refs > 0) {
+                    Logger::warning("Resource still referenced at shutdown: " + entry.name);
+                    free(entry.value);
+                    entry.value = T{};
+                    entry.refs = 0;
+                    ++entry.generation;
+                    ++leaked;
+                }
+                free_slots.push_back(slot);
+            }
+            lookup.clear();
+            stats.live = 0;
+            return leaked;
+        }
+    };
+
+    Pool<std::unique_ptr<MeshData>> s_meshes;
+    Pool<GLuint> s_textures;
+    Pool<std::unique_ptr<ShaderProgram>> s_programs;
+
+    // CPU side results of prefetch_*, consumed by the next load of the same key
+    std::mutex s_prefetch_mutex;
+    std::unordered_map<std::uint64_t, MeshData> s_prefetched_meshes;
+    std::unordered_map<std::uint64_t, TextureBaker::Baked> s_prefetched_textures;
+
+    template <typename T>
+    std::optional<T> take_prefetched(std::unordered_map<std::uint64_t, T>& prefetched, std::uint64_t key) {
+        std::lock_guard lock(s_prefetch_mutex);
+        const auto it = prefetched.find(key);
+        if (it == prefetched.end())
+            return std::nullopt;
+        std::optional<T> value(std::move(it->second));
+        prefetched.erase(it);
+        return value;
+    }
+
+    void free_mesh(std::unique_ptr<MeshData>& data) { data.reset(); }
+    void free_texture(GLuint& texture) {
+        TextureStreamer::cancel(texture);
+        glDeleteTextures(1, &texture);
+        GLState::invalidate(); // deleted names may be reused
+    }
+    void free_program(std::unique_ptr<ShaderProgram>& program) { program->clear(); }
+
+    // mapped from the mesh cache, or parsed + optimized + simplified and written to it
+    MeshData import_obj(const std::filesystem::path& path, std::uint64_t key) {
+        if (MeshCache::enabled)
+            if (auto cached = MeshCache::load(key, path.string()))
+                return std::move(*cached);
+
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+        if (!loadOBJ(path, vertices, indices))
+            throw std::runtime_error("Cannot load OBJ: " + path.string());
+
+        MeshOptimizer::optimize(vertices, indices, path.string());
+        const std::vector<LodLevel> lods = MeshSimplifier::build_lod_chain(vertices, indices);
+        if (!lods.empty()) {
+            std::string message = "LOD chain: " + path.string() + " " + std::to_string(indices.size() / 3);
+            for (const auto& level : lods)
+                message += " / " + std::to_string(level.indices.size() / 3);
+            Logger::info(message + " triangles");
+        }
+
+        MeshData data = MeshCache::assemble(std::move(vertices), std::move(indices), lods);
+        if (MeshCache::enabled)
+            MeshCache::store(key, data, path.string());
+        return data;
+    }
+}
+
+MeshResource ResourceManager::load_mesh(const std::filesystem::path& path) {
+    const std::uint64_t key = mesh_key(path);
+    MeshResource handle;
+    if (s_meshes.acquire(key, handle))
+        return handle;
+    if (auto data = take_prefetched(s_prefetched_meshes, key))
+        return s_meshes.insert<MeshResource>(key, std::make_unique<MeshData>(std::move(*data)), path.string());
+    return s_meshes.insert<MeshResource>(key, std::make_unique<MeshData>(import_obj(path, key)), path.string());
+}
+
+TextureResource ResourceManager::load_texture(const std::filesystem::path& path) {
+    std::vector<unsigned char> bytes = read_file(path);
+    const std::uint64_t key = file_key(path, bytes);
+    TextureResource handle;
+    if (s_textures.acquire(key, handle))
+        return handle;
+
+    // the array layer is baked by load_texture_layer, a 2D texture would be baked and released unused
+    if (texture_layer_size > 0)
+        return s_textures.insert<TextureResource>(key, 0, path.string());
+    if (auto baked = take_prefetched(s_prefetched_textures, key))
+        return s_textures.insert<TextureResource>(key, TextureBaker::upload(*baked), path.string());
+    if (TextureStreamer::active())
+        return s_textures.insert<TextureResource>(key, TextureStreamer::load(std::move(bytes), path.string()), path.string());
+    // baked from the bytes already in memory, the file is read once
+    return s_textures.insert<TextureResource>(key, TextureBaker::upload(TextureBaker::load(bytes, path.string())), path.string());
+}
+
+void ResourceManager::prefetch_mesh(const std::filesystem::path& path) {
+    const std::uint64_t key = mesh_key(path);
+    MeshData data = import_obj(path, key);
+    std::lock_guard lock(s_prefetch_mutex);
+    s_prefetched_meshes.try_emplace(key, std::move(data));
+}
+
+void ResourceManager::prefetch_texture(const std::filesystem::path& path) {
+    const std::vector<unsigned char> bytes = read_file(path);
+    const std::uint64_t key = file_key(path, bytes);
+    // prefetches run side by side on the job graph workers
+    const bool pool_thread = std::exchange(TextureBaker::pool_thread, true);
+    TextureBaker::Baked baked = TextureBaker::load(bytes, path.string(), texture_layer_size);
+    TextureBaker::pool_thread = pool_thread;
+    std::lock_guard lock(s_prefetch_mutex);
+    s_prefetched_textures.try_emplace(key, std::move(baked));
+}
+
+ProgramResource ResourceManager::load_program(const std::filesystem::path& vs_path, const std::filesystem::path& fs_path) {
+    const std::uint64_t key = file_key(fs_path, read_file(fs_path), file_key(vs_path, read_file(vs_path)));
+    ProgramResource handle;
+    if (s_programs.acquire(key, handle))
+        return handle;
+    return s_programs.insert<ProgramResource>(key, std::make_unique<ShaderProgram>(vs_path, fs_path),
+                                              vs_path.string() + " + " + fs_path.string());
+}
+
+ProgramResource ResourceManager::load_program(const std::filesystem::path& cs_path) {
+    const std::uint64_t key = file_key(cs_path, read_file(cs_path));
+    ProgramResource handle;
+    if (s_programs.acquire(key, handle))
+        return handle;
+    return s_programs.insert<ProgramResource>(key, std::make_unique<ShaderProgram>(cs_path), cs_path.string());
+}
+
+void ResourceManager::reload_programs(const std::filesystem::path& file) {
+    for (auto& entry : s_programs.entries)
+        if (entry.refs > 0 && entry.value->uses(file))
+            entry.value->reload();
+}
+
+void ResourceManager::update_programs() {
+    for (auto& entry : s_programs.entries)
+        if (entry.refs > 0)
+            entry.value->update_reload();
+}
+
+const MeshData& ResourceManager::mesh(MeshResource handle) {
+    auto* entry = s_meshes.find(handle);
+    if (!entry)
+        throw std::runtime_error("ResourceManager: stale mesh handle");
+    return *entry->value;
+}
+
+GLuint ResourceManager::texture(TextureResource handle) {
+    auto* entry = s_textures.find(handle);
+    if (!entry)
+        throw std::runtime_error("ResourceManager: stale texture handle");
+    return entry->value;
+}
+
+void ResourceManager::load_texture_layer(TextureResource handle, GLuint array, std::uint32_t layer, std::uint32_t layer_count,
+                                         std::uint32_t layer_size) {
+    auto* entry = s_textures.find(handle);
+    if (!entry)
+        throw std::runtime_error("ResourceManager: stale texture handle");
+
+    // prefetches are baked at texture_layer_size
+    if (layer_size == texture_layer_size)
+        if (auto baked = take_prefetched(s_prefetched_textures, entry->key))
+            return TextureBaker::upload_layer(array, static_cast<GLint>(layer), *baked);
+    std::vector<unsigned char> bytes = read_file(entry->name);
+    if (TextureStreamer::active())
+        return TextureStreamer::load_layer(array, layer, layer_count, layer_size, std::move(bytes), entry->name);
+    TextureBaker::upload_layer(array, static_cast<GLint>(layer), TextureBaker::load(bytes, entry->name, layer_size));
+}
+
+ShaderProgram& ResourceManager::program(ProgramResource handle) {
+    auto* entry = s_programs.find(handle);
+    if (!entry)
+        throw std::runtime_error("ResourceManager: stale program handle");
+    return *entry->value;
+}
+
+bool ResourceManager::alive(MeshResource handle) noexcept { return s_meshes.find(handle) != nullptr; }
+bool ResourceManager::alive(TextureResource handle) noexcept { return s_textures.find(handle) != nullptr; }
+bool ResourceManager::alive(ProgramResource handle) noexcept { return s_programs.find(handle) != nullptr; }
+
+MeshResource ResourceManager::retain(MeshResource handle) {
+    if (auto* entry = s_meshes.find(handle))
+        ++entry->refs;
+    return handle;
+}
+
+TextureResource ResourceManager::retain(TextureResource handle) {
+    if (auto* entry = s_textures.find(handle))
+        ++entry->refs;
+    return handle;
+}
+
+ProgramResource ResourceManager::retain(ProgramResource handle) {
+    if (auto* entry = s_programs.find(handle))
+        ++entry->refs;
+    return handle;
+}
+
+void ResourceManager::release(MeshResource handle) { s_meshes.release(handle, free_mesh); }
+
+void ResourceManager::release(TextureResource handle) { s_textures.release(handle, free_texture); }
+
+void ResourceManager::release(ProgramResource handle) { s_programs.release(handle, free_program); }
+
+const ResourceManager::Stats& ResourceManager::mesh_stats() noexcept { return s_meshes.stats; }
+const ResourceManager::Stats& ResourceManager::texture_stats() noexcept { return s_textures.stats; }
+const ResourceManager::Stats& ResourceManager::program_stats() noexcept { return s_programs.stats; }
+
+void ResourceManager::clear() {
+    const size_t leaked = s_meshes.clear(free_mesh) + s_textures.clear(free_texture) + s_programs.clear(free_program);
+    {
+        std::lock_guard lock(s_prefetch_mutex);
+        s_prefetched_meshes.clear();
+        s_prefetched_textures.clear();
+    }
+    if (leaked > 0)
+        Logger::warning("ResourceManager: " + std::to_string(leaked) + " resources were not released");
+}
@@ -0,0 +1,93 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 30.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef RESOURCEMANAGER_HPP
+#define RESOURCEMANAGER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <GL/glew.h>
+
+#include "MeshData.hpp"
+#include "ShaderProgram.hpp"
+
+// generational handle, stays invalid after the resource is freed even if the slot is reused
+template <typename Tag>
+struct ResourceHandle {
+    static constexpr std::uint32_t INVALID = 0xFFFFFFFFu;
+
+    std::uint32_t slot = INVALID;
+    std::uint32_t generation = 0;
+
+    explicit operator bool() const noexcept { return slot != INVALID; }
+    bool operator==(const ResourceHandle&) const = default;
+};
+
+using MeshResource = ResourceHandle<struct MeshTag>;
+using TextureResource = ResourceHandle<struct TextureTag>;
+using ProgramResource = ResourceHandle<struct ProgramTag>;
+
+// content addressed cache of meshes (OBJ), textures and shader programs
+// - key = canonical path + hash of the file contents, a repeated load only hashes the file
+// - every load / retain adds a reference, release drops it, the last release frees the GL object immediately
+// - a handle of a freed resource is detected by its generation, get on it throws
+class ResourceManager {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint32_t live = 0;
+    };
+
+    static MeshResource load_mesh(const std::filesystem::path& path); // optimized, with LOD chain
+    static TextureResource load_texture(const std::filesystem::path& path);
+    // CPU part of a load (parse / decode + bake) without GL, safe on worker threads
+    // the next load of the same file takes the result instead of doing the work again
+    static void prefetch_mesh(const std::filesystem::path& path);
+    static void prefetch_texture(const std::filesystem::path& path);
+
+    // returns while the driver still compiles, ShaderProgram waits on first use
+    static ProgramResource load_program(const std::filesystem::path& vs_path, const std::filesystem::path& fs_path);
+    static ProgramResource load_program(const std::filesystem::path& cs_path);
+
+    // live reload: every program built from file is rebuilt, update_programs swaps the linked ones in (per frame)
+    static void reload_programs(const std::filesystem::path& file);
+    static void update_programs();
+
+    static const MeshData& mesh(MeshResource handle);
+    static GLuint texture(TextureResource handle);
+    static ShaderProgram& program(ProgramResource handle);
+
+    // array layer size of the material table (MaterialTextures), 0 = textures are loaded as 2D textures
+    // when set, load_texture only registers the file (texture() is 0) and prefetch_texture bakes at this size,
+    // load_texture_layer then fills the layer from that one bake
+    inline static std::uint32_t texture_layer_size = 0;
+    static void load_texture_layer(TextureResource handle, GLuint array, std::uint32_t layer, std::uint32_t layer_count,
+                                   std::uint32_t layer_size);
+
+    static bool alive(MeshResource handle) noexcept;
+    static bool alive(TextureResource handle) noexcept;
+    static bool alive(ProgramResource handle) noexcept;
+
+    static MeshResource retain(MeshResource handle);
+    static TextureResource retain(TextureResource handle);
+    static ProgramResource retain(ProgramResource handle);
+
+    // invalid or stale handles are ignored
+    static void release(MeshResource handle);
+    static void release(TextureResource handle);
+    static void release(ProgramResource handle);
+
+    static const Stats& mesh_stats() noexcept;
+    static const Stats& texture_stats() noexcept;
+    static const Stats& program_stats() noexcept;
+
+    // FNV-1a, chainable through h
+    static std::uint64_t hash(const void* data, size_t size, std::uint64_t h = 14695981039346656037ull) noexcept;
+
+    static void clear(); // free whatever is still referenced (reported as leak) - dont put in destructor
+};
+
+#endif //RESOURCEMANAGER_HPP
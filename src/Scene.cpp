@@ -0,0 +1,319 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 26.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SCENE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#include "Scene.hpp"
+#include "Logger.hpp"
+
+namespace {
+    // out = a * b, one column of out is a linear combination of the columns of a
+    void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+#ifdef SCENE_SSE
+        const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+        const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+        const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+        const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+        for (int col = 0; col < 4; ++col) {
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[col][0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[col][1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[col][2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[col][3])));
+            _mm_storeu_ps(&out[col][0], r);
+        }
+#else
+        out = a * b;
+#endif
+    }
+
+    // transpose(inverse(m3)) from cofactors: columns are cross products of the other two columns
+    glm::mat3 normal_matrix(const glm::mat4& m) {
+        const glm::vec3 a(m[0]), b(m[1]), c(m[2]);
+        const glm::vec3 bc = glm::cross(b, c);
+        const float det = glm::dot(a, bc);
+        if (std::abs(det) < 1e-12f)
+            return glm::mat3(1.0f);
+        const float inv_det = 1.0f / det;
+        return glm::mat3(bc * inv_det, glm::cross(c, a) * inv_det, glm::cross(a, b) * inv_det);
+    }
+}
+
+glm::mat4 Transform::matrix() const {
+    // S * Rz * Ry * Rx * T
+    const float cx = std::cos(orientation.x), sx = std::sin(orientation.x);
+    const float cy = std::cos(orientation.y), sy = std::sin(orientation.y);
+    const float cz = std::cos(orientation.z), sz = std::sin(orientation.z);
+
+    glm::mat4 m(1.0f);
+    m[0] = glm::vec4(scale.x * cz * cy, scale.y * sz * cy, scale.z * -sy, 0.0f);
+    m[1] = glm::vec4(scale.x * (cz * sy * sx - sz * cx), scale.y * (sz * sy * sx + cz * cx), scale.z * cy * sx, 0.0f);
+    m[2] = glm::vec4(scale.x * (cz * sy * cx + sz * sx), scale.y * (sz * sy * cx - cz * sx), scale.z * cy * cx, 0.0f);
+    m[3] = glm::vec4(glm::vec3(m[0]) * origin.x + glm::vec3(m[1]) * origin.y + glm::vec3(m[2]) * origin.z, 1.0f);
+
+    glm::mat4 out;
+    multiply(local_matrix, m, out);
+    return out;
+}
+
+Entity Scene::create(const Model& model, std::string_view name, Entity parent) {
+    std::uint32_t slot;
+    if (!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+
+    const auto dense = static_cast<std::uint32_t>(m_transforms.size());
+    m_slots[slot].dense = dense;
+    m_dense_to_slot.push_back(slot);
+
+    Transform transform;
+    transform.origin = model.m_origin;
+    transform.orientation = model.orientation;
+    transform.scale = model.scale;
+    transform.local_matrix = model.local_model_matrix;
+    m_transforms.push_back(transform);
+    world_matrices.push_back(transform.matrix());
+    normal_matrices.push_back(normal_matrix(world_matrices.back()));
+    parents.push_back(Entity::INVALID);
+    m_dirty.push_back(0);
+    m_order.push_back(dense);
+
+    bounds_min.push_back(model.bounds_min);
+    bounds_max.push_back(model.bounds_max);
+
+    MeshHandle handle{static_cast<std::uint32_t>(m_mesh_list.size()), static_cast<std::uint32_t>(model.meshes.size())};
+    for (const auto& mesh : model.meshes) {
+        m_mesh_list.push_back(mesh.get());
+        if (m_mesh_lookup.insert(mesh.get()).second)
+            m_mesh_owners.push_back(mesh);
+    }
+    meshes.push_back(handle);
+
+    tex_scales.push_back(1.0f);
+    lods.push_back(0);
+    flags.push_back(static_cast<std::uint8_t>((model.transparent ? ENTITY_TRANSPARENT : 0) | (model.dynamic ? ENTITY_DYNAMIC : 0)));
+
+    const Entity entity{slot, m_slots[slot].generation};
+    if (!name.empty())
+        m_names[std::string(name)] = entity;
+    if (parent)
+        set_parent(entity, parent);
+    return entity;
+}
+
+void Scene::destroy(Entity entity) {
+    if (!alive(entity))
+        return;
+
+    const std::uint32_t dense = m_slots[entity.slot].dense;
+    const auto last = static_cast<std::uint32_t>(m_transforms.size() - 1);
+
+    if (m_dirty[dense])
+        --m_dirty_count;
+
+    // detach children, repoint children of the moved entity
+    for (auto& parent : parents) {
+        if (parent == dense)
+            parent = Entity::INVALID;
+        else if (parent == last)
+            parent = dense;
+    }
+
+    // move last entity into the hole to keep arrays dense
+    if (dense != last) {
+        m_transforms[dense] = m_transforms[last];
+        m_dirty[dense] = m_dirty[last];
+        parents[dense] = parents[last];
+        world_matrices[dense] = world_matrices[last];
+        normal_matrices[dense] = normal_matrices[last];
+        bounds_min[dense] = bounds_min[last];
+        bounds_max[dense] = bounds_max[last];
+        meshes[dense] = meshes[last];
+        tex_scales[dense] = tex_scales[last];
+        lods[dense] = lods[last];
+        flags[dense] = flags[last];
+        m_dense_to_slot[dense] = m_dense_to_slot[last];
+        m_slots[m_dense_to_slot[dense]].dense = dense;
+    }
+    m_transforms.pop_back();
+    m_dirty.pop_back();
+    parents.pop_back();
+    world_matrices.pop_back();
+    normal_matrices.pop_back();
+    bounds_min.pop_back();
+    bounds_max.pop_back();
+    meshes.pop_back();
+    tex_scales.pop_back();
+    lods.pop_back();
+    flags.pop_back();
+    m_dense_to_slot.pop_back();
+
+    m_slots[entity.slot].dense = Entity::INVALID;
+    ++m_slots[entity.slot].generation;
+    m_free_slots.push_back(entity.slot);
+    m_order_dirty = true;
+
+    std::erase_if(m_names, [&](const auto& item) { return item.second == entity; });
+}
+
+bool Scene::alive(Entity entity) const noexcept {
+    return entity.slot < m_slots.size()
+        && m_slots[entity.slot].generation == entity.generation
+        && m_slots[entity.slot].dense != Entity::INVALID;
+}
+
+std::uint32_t Scene::dense(Entity entity) const noexcept {
+    return alive(entity) ? m_slots[entity.slot].dense : Entity::INVALID;
+}
+
+Entity Scene::entity(std::uint32_t dense) const noexcept {
+    if (dense >= m_dense_to_slot.size())
+        return {};
+    const std::uint32_t slot = m_dense_to_slot[dense];
+    return {slot, m_slots[slot].generation};
+}
+
+Entity Scene::find(std::string_view name) const {
+    auto it = m_names.find(std::string(name));
+    if (it != m_names.end() && alive(it->second))
+        return it->second;
+    Logger::error("Entity not found: " + std::string(name));
+    return {};
+}
+
+void Scene::set_parent(Entity child, Entity parent) {
+    const std::uint32_t c = dense(child);
+    if (c == Entity::INVALID)
+        return;
+    const std::uint32_t p = dense(parent);
+
+    // refuse cycles
+    for (std::uint32_t a = p; a != Entity::INVALID; a = parents[a]) {
+        if (a == c) {
+            Logger::error("Scene: parenting would create a cycle");
+            return;
+        }
+    }
+
+    parents[c] = p;
+    m_order_dirty = true;
+    mark_dirty(c);
+}
+
+Transform& Scene::edit_transform(std::uint32_t dense) noexcept {
+    mark_dirty(dense);
+    return m_transforms[dense];
+}
+
+void Scene::mark_dirty(std::uint32_t dense) noexcept {
+    if (!m_dirty[dense]) {
+        m_dirty[dense] = 1;
+        ++m_dirty_count;
+    }
+}
+
+void Scene::rebuild_order() {
+    std::vector<std::uint32_t> depth(m_transforms.size(), 0);
+    for (std::uint32_t i = 0; i < depth.size(); ++i)
+        for (std::uint32_t a = parents[i]; a != Entity::INVALID; a = parents[a])
+            ++depth[i];
+
+    m_order.resize(m_transforms.size());
+    for (std::uint32_t i = 0; i < m_order.size(); ++i)
+        m_order[i] = i;
+    std::ranges::stable_sort(m_order, {}, [&](std::uint32_t i) { return depth[i]; });
+    m_order_dirty = false;
+}
+
+void Scene::update_world() {
+    if (m_dirty_count == 0)
+        return;
+    if (m_order_dirty)
+        rebuild_order();
+
+    // dirty entities and everything below them, parents come first
+    m_update_list.clear();
+    for (const std::uint32_t i : m_order) {
+        if (!m_dirty[i] && parents[i] != Entity::INVALID && m_dirty[parents[i]])
+            m_dirty[i] = 1;
+        if (m_dirty[i])
+            m_update_list.push_back(i);
+    }
+
+    // local matrices first, then parent multiply, the list keeps parents ahead of children
+    m_local_scratch.resize(m_update_list.size());
+    for (size_t k = 0; k < m_update_list.size(); ++k)
+        m_local_scratch[k] = m_transforms[m_update_list[k]].matrix();
+
+    for (size_t k = 0; k < m_update_list.size(); ++k) {
+        const std::uint32_t i = m_update_list[k];
+        if (parents[i] != Entity::INVALID)
+            multiply(world_matrices[parents[i]], m_local_scratch[k], world_matrices[i]);
+        else
+            world_matrices[i] = m_local_scratch[k];
+        normal_matrices[i] = normal_matrix(world_matrices[i]);
+        m_dirty[i] = 0;
+    }
+
+    m_transform_updates += m_update_list.size();
+    m_dirty_count = 0;
+}
+
+void Scene::world_bounds(std::uint32_t dense, glm::vec3& out_min, glm::vec3& out_max) const {
+    // Arvo: transformed extent is |M| * extent
+    const glm::mat4& m = world_matrices[dense];
+    const glm::vec3 center = glm::vec3(m * glm::vec4((bounds_min[dense] + bounds_max[dense]) * 0.5f, 1.0f));
+    const glm::vec3 extent = (bounds_max[dense] - bounds_min[dense]) * 0.5f;
+
+    glm::vec3 world_extent(0.0f);
+    for (int col = 0; col < 3; ++col)
+        for (int row = 0; row < 3; ++row)
+            world_extent[row] += std::abs(m[col][row]) * extent[col];
+
+    out_min = center - world_extent;
+    out_max = center + world_extent;
+}
+
+size_t Scene::mesh_bytes() const noexcept {
+    size_t bytes = 0;
+    for (const auto& mesh : m_mesh_owners)
+        bytes += mesh->gpu_bytes();
+    return bytes;
+}
+
+void Scene::clear() {
+    for (const auto& mesh : m_mesh_owners)
+        mesh->clear();
+    m_mesh_owners.clear();
+    m_mesh_lookup.clear();
+    m_mesh_list.clear();
+    m_names.clear();
+    m_slots.clear();
+    m_free_slots.clear();
+    m_dense_to_slot.clear();
+    m_transforms.clear();
+    m_dirty.clear();
+    m_dirty_count = 0;
+    m_order.clear();
+    m_order_dirty = false;
+    parents.clear();
+    world_matrices.clear();
+    normal_matrices.clear();
+    bounds_min.clear();
+    bounds_max.clear();
+    meshes.clear();
+    tex_scales.clear();
+    lods.clear();
+    flags.clear();
+}
@@ -0,0 +1,135 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 26.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+#include "Model.hpp"
+
+// generational handle, stays invalid after its entity is destroyed even if the slot is reused
+struct Entity {
+    static constexpr std::uint32_t INVALID = 0xFFFFFFFFu;
+
+    std::uint32_t slot = INVALID;
+    std::uint32_t generation = 0;
+
+    explicit operator bool() const noexcept { return slot != INVALID; }
+    bool operator==(const Entity&) const = default;
+};
+
+// local TRS, world = parent world * local_matrix * S * Rz * Ry * Rx * T (same as Model::get_model_matrix)
+struct Transform {
+    glm::vec3 origin{0.0f};
+    glm::vec3 orientation{0.0f}; // rotation by x,y,z axis, in radians
+    glm::vec3 scale{1.0f};
+    glm::mat4 local_matrix{1.0f};
+
+    // closed form, no intermediate glm::rotate/scale/translate matrices
+    glm::mat4 matrix() const;
+};
+
+// range inside Scene mesh list
+struct MeshHandle {
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
+
+enum EntityFlags : std::uint8_t {
+    ENTITY_TRANSPARENT = 1 << 0,
+    ENTITY_DYNAMIC     = 1 << 1,
+};
+
+// entity store, components live in dense parallel arrays indexed by dense id
+// - destroy swaps the last entity into the hole, dense ids are stable only between destroys
+// - handles resolve through a slot table (slot -> dense id + generation)
+// - names are a side index for setup code, per frame code keeps handles or dense ids
+// - world and normal matrices are cached, only transforms edited through edit_transform()
+//   (and their children) are recomputed by update_world()
+class Scene {
+public:
+    Entity create(const Model& model, std::string_view name = {}, Entity parent = {});
+    void destroy(Entity entity); // children are detached and keep their last world matrix
+    void set_parent(Entity child, Entity parent);
+
+    bool alive(Entity entity) const noexcept;
+    std::uint32_t dense(Entity entity) const noexcept; // Entity::INVALID when not alive
+    Entity entity(std::uint32_t dense) const noexcept;
+    Entity find(std::string_view name) const;          // setup only
+
+    size_t size() const noexcept { return m_transforms.size(); }
+
+    const Transform& transform(std::uint32_t dense) const noexcept { return m_transforms[dense]; }
+    Transform& edit_transform(std::uint32_t dense) noexcept; // marks the transform dirty
+
+    // recompute dirty world + normal matrices, parents before children, nothing to do for static scenes
+    void update_world();
+    std::uint64_t transform_updates() const noexcept { return m_transform_updates; } // total recomputed matrices
+
+    // world space AABB enclosing the transformed local bounds
+    void world_bounds(std::uint32_t dense, glm::vec3& out_min, glm::vec3& out_max) const;
+
+    std::span<Mesh* const> meshes_of(std::uint32_t dense) const noexcept {
+        return {m_mesh_list.data() + meshes[dense].first, meshes[dense].count};
+    }
+
+    bool is_transparent(std::uint32_t dense) const noexcept { return flags[dense] & ENTITY_TRANSPARENT; }
+    bool is_dynamic(std::uint32_t dense) const noexcept { return flags[dense] & ENTITY_DYNAMIC; }
+
+    size_t mesh_bytes() const noexcept; // GPU vertex + index data of all unique meshes
+
+    void clear(); // deallocate meshes - dont put in destructor
+
+    // dense components (read only outside of Scene, transforms go through edit_transform)
+    std::vector<glm::mat4> world_matrices;
+    std::vector<glm::mat3> normal_matrices;   // transpose(inverse(mat3(world)))
+    std::vector<std::uint32_t> parents;       // dense id, Entity::INVALID for roots
+    std::vector<glm::vec3> bounds_min; // local space
+    std::vector<glm::vec3> bounds_max;
+    std::vector<MeshHandle> meshes;
+    std::vector<float> tex_scales;     // material
+    std::vector<std::uint8_t> lods;    // selected level of detail, kept between frames for hysteresis
+    std::vector<std::uint8_t> flags;
+
+private:
+    struct Slot {
+        std::uint32_t dense = Entity::INVALID;
+        std::uint32_t generation = 0;
+    };
+
+    void mark_dirty(std::uint32_t dense) noexcept;
+    void rebuild_order();
+
+    std::vector<Transform> m_transforms;
+    std::vector<std::uint8_t> m_dirty;
+    size_t m_dirty_count = 0;
+    std::uint64_t m_transform_updates = 0;
+    std::vector<std::uint32_t> m_order; // dense ids sorted by hierarchy depth
+    bool m_order_dirty = false;
+    std::vector<std::uint32_t> m_update_list;
+    std::vector<glm::mat4> m_local_scratch;
+
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_free_slots;
+    std::vector<std::uint32_t> m_dense_to_slot;
+
+    std::vector<Mesh*> m_mesh_list;                      // referenced by MeshHandle
+    std::vector<std::shared_ptr<Mesh>> m_mesh_owners;    // keeps GL meshes alive, one per unique mesh
+    std::unordered_set<const Mesh*> m_mesh_lookup;
+
+    std::unordered_map<std::string, Entity> m_names;
+};
+
+#endif //SCENE_HPP
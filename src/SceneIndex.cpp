@@ -0,0 +1,98 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 23.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#include "SceneIndex.hpp"
+
+SceneIndex::SceneIndex(float cell_size)
+    : m_cell_size(cell_size) {}
+
+void SceneIndex::build(const Scene& scene) {
+    std::vector<std::uint32_t> entities(scene.size());
+    for (std::uint32_t i = 0; i < scene.size(); ++i)
+        entities[i] = i;
+    build(scene, entities);
+}
+
+void SceneIndex::build(const Scene& scene, std::span<const std::uint32_t> entities) {
+    m_cells.clear();
+    m_cell_bounds.clear();
+    m_static.clear();
+    m_static_bounds.clear();
+    m_dynamic.clear();
+    m_dynamic_bounds.clear();
+
+    struct Entry {
+        std::uint32_t entity;
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+    // cell key -> entities, cells are sparse (objects may lie far outside the maze)
+    std::unordered_map<std::int64_t, std::vector<Entry>> buckets;
+
+    for (const std::uint32_t i : entities) {
+        glm::vec3 min, max;
+        scene.world_bounds(i, min, max);
+
+        if (scene.is_dynamic(i)) {
+            m_dynamic.push_back(i);
+            m_dynamic_bounds.push(min, max);
+            continue;
+        }
+
+        const glm::vec3 center = (min + max) * 0.5f;
+        const auto cx = static_cast<std::int32_t>(std::floor(center.x / m_cell_size));
+        const auto cz = static_cast<std::int32_t>(std::floor(center.z / m_cell_size));
+        const std::int64_t key = (static_cast<std::int64_t>(cx) << 32) | static_cast<std::uint32_t>(cz);
+        buckets[key].push_back({i, min, max});
+    }
+
+    for (const auto& [key, entries] : buckets) {
+        glm::vec3 cell_min(std::numeric_limits<float>::max());
+        glm::vec3 cell_max(std::numeric_limits<float>::lowest());
+
+        m_cells.push_back({m_static.size(), entries.size()});
+        for (const auto& entry : entries) {
+            m_static.push_back(entry.entity);
+            m_static_bounds.push(entry.min, entry.max);
+            cell_min = glm::min(cell_min, entry.min);
+            cell_max = glm::max(cell_max, entry.max);
+        }
+        m_cell_bounds.push(cell_min, cell_max);
+    }
+
+    m_cell_visible.resize(m_cells.size());
+    m_object_visible.resize(std::max(m_static.size(), m_dynamic.size()));
+}
+
+void SceneIndex::query(const Scene& scene, const Frustum& frustum, std::vector<std::uint32_t>& visible) {
+    visible.clear();
+
+    frustum.test(m_cell_bounds, 0, m_cells.size(), m_cell_visible.data());
+    for (size_t c = 0; c < m_cells.size(); ++c) {
+        if (!m_cell_visible[c])
+            continue;
+
+        const Cell& cell = m_cells[c];
+        frustum.test(m_static_bounds, cell.first, cell.count, m_object_visible.data());
+        for (size_t i = 0; i < cell.count; ++i)
+            if (m_object_visible[i])
+                visible.push_back(m_static[cell.first + i]);
+    }
+
+    for (size_t i = 0; i < m_dynamic.size(); ++i) {
+        glm::vec3 min, max;
+        scene.world_bounds(m_dynamic[i], min, max);
+        m_dynamic_bounds.set(i, min, max);
+    }
+    frustum.test(m_dynamic_bounds, 0, m_dynamic.size(), m_object_visible.data());
+    for (size_t i = 0; i < m_dynamic.size(); ++i)
+        if (m_object_visible[i])
+            visible.push_back(m_dynamic[i]);
+}
@@ -0,0 +1,56 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 23.5.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef SCENEINDEX_HPP
+#define SCENEINDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Frustum.hpp"
+#include "Scene.hpp"
+
+// loose uniform grid over the XZ plane for frustum culling of scene entities
+// - static entities are stored in the cell of their AABB center, cell bounds grow to enclose them
+// - dynamic entities sit in a flat list and get their bounds refreshed on every query
+// - cells are tested first, only entities of visible cells are tested one by one
+// stores dense ids, rebuild after entities are destroyed
+class SceneIndex {
+public:
+    explicit SceneIndex(float cell_size = 8.0f);
+
+    void build(const Scene& scene);
+    void build(const Scene& scene, std::span<const std::uint32_t> entities); // only these dense ids
+
+    // fills visible with dense ids of entities intersecting the frustum
+    void query(const Scene& scene, const Frustum& frustum, std::vector<std::uint32_t>& visible);
+
+    size_t size() const noexcept { return m_static.size() + m_dynamic.size(); }
+    size_t cell_count() const noexcept { return m_cells.size(); }
+
+private:
+    struct Cell {
+        size_t first;
+        size_t count;
+    };
+
+    float m_cell_size;
+
+    std::vector<Cell> m_cells;
+    AabbList m_cell_bounds;
+
+    std::vector<std::uint32_t> m_static; // ordered by cell
+    AabbList m_static_bounds;
+
+    std::vector<std::uint32_t> m_dynamic;
+    AabbList m_dynamic_bounds;
+
+    std::vector<std::uint8_t> m_cell_visible;
+    std::vector<std::uint8_t> m_object_visible;
+};
+
+#endif //SCENEINDEX_HPP
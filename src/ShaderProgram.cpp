@@ -1,6 +1,11 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <random>
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
@@ -11,85 +16,592 @@
 
 #include "Logger.hpp"
 
-// set uniform according to name 
+namespace {
+	struct BinaryHeader {
+		char magic[4];
+		std::uint32_t version;
+		std::uint64_t key;
+		std::uint32_t format; // driver specific, from glGetProgramBinary
+		std::uint32_t size;
+	};
+
+	constexpr std::uint32_t MAX_BINARY_SIZE = 64u << 20;
+
+	std::filesystem::path binary_path(std::uint64_t key) {
+		char file_name[32];
+		std::snprintf(file_name, sizeof(file_name), "%016llx.bprog", static_cast<unsigned long long>(key));
+		return ShaderProgram::cache_dir / file_name;
+	}
+
+	std::string read_binary_file(const std::filesystem::path& filename) {
+		std::ifstream file(filename, std::ios::binary);
+		if (!file.is_open())
+			throw std::runtime_error("Error opening file: " + filename.string());
+		return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	}
+
+	std::string_view bytes_of(const GLenum& value) {
+		return { reinterpret_cast<const char*>(&value), sizeof(value) };
+	}
+
+	// #version (and a BOM or comments before it) has to stay first, #line keeps compiler messages on the file lines
+	void inject_defines(std::string& code, const std::string& defines) {
+		std::size_t at = 0;
+		const std::size_t version = code.find("#version");
+		if (version != std::string::npos) {
+			at = code.find('\n', version);
+			at = at == std::string::npos ? code.size() : at + 1;
+		}
+		const auto line = std::count(code.begin(), code.begin() + at, '\n') + 1;
+		std::string block = defines;
+		if (at == code.size() && (at == 0 || code.back() != '\n'))
+			block.insert(0, "\n");
+		block += "#line " + std::to_string(line) + "\n";
+		code.insert(at, block);
+	}
+}
+
+// set uniform according to handle
 // https://docs.gl/gl4/glUniform
 
+void ShaderProgram::init_parallel_compile()
+{
+	// as many driver threads as it wants
+	if (GLEW_KHR_parallel_shader_compile)
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+	else if (GLEW_ARB_parallel_shader_compile)
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+}
+
 ShaderProgram::ShaderProgram(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file)
+	: m_files{ { VS_file, GL_VERTEX_SHADER }, { FS_file, GL_FRAGMENT_SHADER } },
+	  m_name(VS_file.string() + " + " + FS_file.string())
+{
+	m_pending = start_build(m_defines);
+	ID = m_pending.program;
+}
+
+ShaderProgram::ShaderProgram(const std::filesystem::path& CS_file)
+	: m_files{ { CS_file, GL_COMPUTE_SHADER } },
+	  m_name(CS_file.string())
 {
-	std::vector<GLuint> shader_ids;
+	m_pending = start_build(m_defines);
+	ID = m_pending.program;
+}
 
-	shader_ids.push_back(compile_shader(VS_file, GL_VERTEX_SHADER));
-	shader_ids.push_back(compile_shader(FS_file, GL_FRAGMENT_SHADER));
+std::string ShaderProgram::define_block(Defines defines)
+{
+	// same set in any order = same variant
+	std::sort(defines.begin(), defines.end());
+	std::string block;
+	for (const auto& [name, value] : defines)
+		block += "#define " + name + " " + std::to_string(value) + "\n";
+	return block;
+}
 
-	ID = link_shader(shader_ids);
+ShaderProgram::Build ShaderProgram::start_build(const std::string& defines)
+{
+	// a module is one fixed variant, defines need the GLSL text
+	const bool use_spirv = spirv && defines.empty() && (GLEW_VERSION_4_6 || GLEW_ARB_gl_spirv);
+	std::vector<Stage> stages;
+	for (const auto& [file, type] : m_files) {
+		Stage stage{ file, type };
+		std::filesystem::path module = file;
+		module += ".spv";
+		std::error_code ec;
+		// a missing GLSL file reports the oldest time, a shipped module alone is enough
+		if (use_spirv && std::filesystem::exists(module, ec)
+			&& std::filesystem::last_write_time(module, ec) >= std::filesystem::last_write_time(file, ec)) {
+			stage.code = read_binary_file(module);
+			stage.spirv = true;
+		}
+		else {
+			stage.code = textFileRead(file);
+			if (!defines.empty())
+				inject_defines(stage.code, defines);
+		}
+		stages.push_back(std::move(stage));
+	}
+
+	Build build;
+	GLint formats = 0;
+	if (binary_cache && (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary))
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats > 0) {
+		build.key = binary_key(stages);
+		build.program = load_binary(build.key);
+		if (build.program != 0)
+			return build;
+		build.save_binary = true;
+	}
+
+	for (const Stage& stage : stages) {
+		build.shaders.push_back(compile_shader(stage));
+		build.files.push_back(stage.file);
+	}
+	build.program = link_shader(build.shaders);
+	return build;
+}
+
+bool ShaderProgram::build_complete(const Build& build)
+{
+	if (build.program == 0 || build.shaders.empty())
+		return true;
+	// without the extension there is nothing to poll, finishing blocks
+	if (!GLEW_KHR_parallel_shader_compile && !GLEW_ARB_parallel_shader_compile)
+		return true;
+	GLint done = GL_FALSE;
+	glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &done);
+	return done == GL_TRUE;
+}
+
+GLuint ShaderProgram::finish_build(Build& build)
+{
+	// status queries wait for the driver threads
+	GLint status = GL_FALSE;
+	for (size_t i = 0; i < build.shaders.size(); ++i) {
+		glGetShaderiv(build.shaders[i], GL_COMPILE_STATUS, &status);
+		if (status == GL_FALSE) {
+			Logger::error("Shader compilation failed for " + build.files[i].string() + ":\n" + getShaderInfoLog(build.shaders[i]));
+			discard(build);
+			throw std::runtime_error("Shader compile err.\n");
+		}
+	}
+	if (!build.shaders.empty()) {
+		glGetProgramiv(build.program, GL_LINK_STATUS, &status);
+		if (status == GL_FALSE) {
+			Logger::error("Program link failed for " + m_name + ":\n" + getProgramInfoLog(build.program));
+			discard(build);
+			throw std::runtime_error("Link err.\n");
+		}
+		for (const auto s_id : build.shaders) {
+			glDetachShader(build.program, s_id);
+			glDeleteShader(s_id);
+		}
+		if (build.save_binary)
+			save_binary(build.program, build.key);
+	}
 
-	for (const auto s_id : shader_ids) {
-		glDetachObjectARB(ID, s_id);
+	const GLuint program = build.program;
+	build = {};
+	return program;
+}
+
+void ShaderProgram::discard(Build& build)
+{
+	for (const auto s_id : build.shaders)
 		glDeleteShader(s_id);
+	glDeleteProgram(build.program);
+	build = {};
+}
+
+void ShaderProgram::finish_pending()
+{
+	try {
+		ID = finish_build(m_pending);
+	}
+	catch (...) {
+		ID = 0;
+		throw;
 	}
+	reflect_uniforms();
 }
 
-void ShaderProgram::setUniform(const std::string& name, const float val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+bool ShaderProgram::uses(const std::filesystem::path& file) const
+{
+	std::error_code ec;
+	const std::filesystem::path changed = std::filesystem::weakly_canonical(file, ec);
+	for (const auto& [stage_file, type] : m_files) {
+		std::filesystem::path module = std::filesystem::weakly_canonical(stage_file, ec);
+		if (module == changed)
+			return true;
+		module += ".spv";
+		if (module == changed)
+			return true;
 	}
-	glUniform1f(loc, val);
+	return false;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const int val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
+void ShaderProgram::reload()
+{
+	if (m_files.empty())
 		return;
+	discard(m_reload); // a newer edit replaces a build still in flight
+	try {
+		m_reload = start_build(m_defines);
+		Logger::info("Shader reload: " + m_name);
+	}
+	catch (const std::exception& e) {
+		Logger::warning("Shader reload failed for " + m_name + ": " + e.what());
+	}
+
+	// not in use, rebuilt in the background and checked when selected
+	for (auto it = m_variants.begin(); it != m_variants.end(); ) {
+		Variant& variant = it->second;
+		discard(variant.pending);
+		glDeleteProgram(variant.id);
+		variant = {};
+		try {
+			variant.pending = start_build(it->first);
+			++it;
+		}
+		catch (const std::exception&) {
+			it = m_variants.erase(it); // source unreadable, the reload above reported it
+		}
 	}
-	glUniform1i(loc, val);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const double val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+void ShaderProgram::select(const Defines& defines)
+{
+	std::string block = define_block(defines);
+	if (block == m_defines || m_reload.program != 0)
+		return; // a live reload of the selected variant finishes first, the next call switches
+
+	// park the selected variant, its values seed the next one
+	Variant& previous = m_variants[m_defines];
+	previous.id = m_pending.program == 0 ? ID : 0;
+	previous.pending = std::exchange(m_pending, {});
+	previous.uniforms = std::move(m_uniforms);
+	previous.shadow = std::move(m_shadow);
+	m_uniforms.clear();
+	m_shadow.clear();
+
+	auto it = m_variants.find(block);
+	if (it == m_variants.end()) {
+		m_pending = start_build(block); // lazily, this frame waits for it
+		ID = m_pending.program;
 	}
-	glUniform1d(loc, val);
+	else {
+		Variant& variant = it->second;
+		if (variant.id != 0) {
+			ID = variant.id;
+			m_uniforms = std::move(variant.uniforms);
+			m_shadow = std::move(variant.shadow);
+		}
+		else {
+			m_pending = std::move(variant.pending);
+			ID = m_pending.program;
+		}
+		m_variants.erase(it); // previous stays valid, only the erased element is invalidated
+	}
+	m_defines = std::move(block);
+
+	finish();
+	restore_uniforms(previous.uniforms, previous.shadow);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec3 val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
+void ShaderProgram::prewarm(const Defines& defines)
+{
+	std::string block = define_block(defines);
+	if (block == m_defines || m_variants.contains(block))
 		return;
+	Variant variant;
+	variant.pending = start_build(block);
+	m_variants.emplace(std::move(block), std::move(variant));
+}
+
+bool ShaderProgram::ready(const Defines& defines) const
+{
+	const std::string block = define_block(defines);
+	if (block == m_defines)
+		return ready();
+	const auto it = m_variants.find(block);
+	return it != m_variants.end() && (it->second.id != 0 || build_complete(it->second.pending));
+}
+
+bool ShaderProgram::update_reload()
+{
+	if (m_reload.program == 0 || !build_complete(m_reload))
+		return false;
+
+	GLuint program;
+	try {
+		program = finish_build(m_reload);
 	}
-	glUniform3fv(loc, 1, glm::value_ptr(val));
+	catch (const std::exception&) {
+		Logger::warning("Shader reload: keeping the previous program of " + m_name);
+		return false;
+	}
+	finish();
+
+	// swap, uniforms set once (samplers, mode switches) keep their values
+	std::vector<UniformSlot> slots = std::move(m_uniforms);
+	std::vector<std::byte> shadow = std::move(m_shadow);
+	glDeleteProgram(ID); // deferred by GL while it is still in use
+	ID = program;
+	GLState::invalidate(); // the cached current program is gone
+	reflect_uniforms();
+	restore_uniforms(slots, shadow);
+	return true;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec4 in_vec4) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+std::uint64_t ShaderProgram::binary_key(const std::vector<Stage>& stages)
+{
+	std::uint64_t h = UniformId::fnv1a(std::string_view(reinterpret_cast<const char*>(&BINARY_VERSION), sizeof(BINARY_VERSION)));
+	// binaries of another driver or GPU are rejected by glProgramBinary anyway, this avoids trying them
+	for (const GLenum property : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const auto* value = reinterpret_cast<const char*>(glGetString(property));
+		h = UniformId::fnv1a(value ? value : "", h);
 	}
-	glUniform4fv(loc, 1, glm::value_ptr(in_vec4));
+	for (const Stage& stage : stages) {
+		h = UniformId::fnv1a(bytes_of(stage.type), h);
+		h = UniformId::fnv1a(stage.spirv ? "spv" : "glsl", h);
+		h = UniformId::fnv1a(stage.code, h);
+	}
+	return h;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat3 val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+GLuint ShaderProgram::load_binary(std::uint64_t key)
+{
+	const std::filesystem::path path = binary_path(key);
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return 0;
+
+	BinaryHeader header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || std::memcmp(header.magic, "BPRG", 4) != 0 || header.version != BINARY_VERSION || header.key != key
+		|| header.size == 0 || header.size > MAX_BINARY_SIZE) {
+		Logger::warning("Program cache: ignoring invalid " + path.string());
+		return 0;
+	}
+	std::vector<char> binary(header.size);
+	file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+	if (!file) {
+		Logger::warning("Program cache: truncated " + path.string());
+		return 0;
 	}
-	glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(val));
+
+	const GLuint prog_h = glCreateProgram();
+	glProgramBinary(prog_h, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+	GLint status = GL_FALSE;
+	glGetProgramiv(prog_h, GL_LINK_STATUS, &status);
+	if (status == GL_FALSE) {
+		// driver update or different binary format, compiled from source and overwritten
+		Logger::warning("Program cache: binary rejected, recompiling " + m_name);
+		glDeleteProgram(prog_h);
+		return 0;
+	}
+	return prog_h;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat4 val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
+void ShaderProgram::save_binary(GLuint program, std::uint64_t key)
+{
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0 || static_cast<std::uint32_t>(length) > MAX_BINARY_SIZE)
 		return;
+	std::vector<char> binary(static_cast<size_t>(length));
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	const std::filesystem::path path = binary_path(key);
+	std::error_code ec;
+	std::filesystem::create_directories(path.parent_path(), ec);
+
+	// written aside and renamed, a crash or another instance never leaves a partial blob under the cache name
+	const BinaryHeader header{ { 'B', 'P', 'R', 'G' }, BINARY_VERSION, key, format, static_cast<std::uint32_t>(length) };
+	std::filesystem::path temp = path;
+	temp += "." + std::to_string(std::random_device{}()) + ".tmp";
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), length);
+		if (!file) {
+			Logger::warning("Program cache: cannot write " + path.string() + " (" + m_name + ")");
+			file.close();
+			std::filesystem::remove(temp, ec);
+			return;
+		}
+	}
+	std::filesystem::rename(temp, path, ec);
+	if (ec) {
+		Logger::warning("Program cache: cannot write " + path.string() + " (" + m_name + "): " + ec.message());
+		std::filesystem::remove(temp, ec);
+	}
+}
+
+void ShaderProgram::setUniform(UniformId id, const float val) {
+	if (const auto* u = prepare_upload(id, GL_FLOAT, &val, sizeof(val)))
+		glProgramUniform1f(ID, u->location, val);
+}
+
+void ShaderProgram::setUniform(UniformId id, const int val) {
+	if (const auto* u = prepare_upload(id, GL_INT, &val, sizeof(val)))
+		glProgramUniform1i(ID, u->location, val);
+}
+
+void ShaderProgram::setUniform(UniformId id, const double val) {
+	if (const auto* u = prepare_upload(id, GL_DOUBLE, &val, sizeof(val)))
+		glProgramUniform1d(ID, u->location, val);
+}
+
+void ShaderProgram::setUniform(UniformId id, const glm::vec2 val) {
+	if (const auto* u = prepare_upload(id, GL_FLOAT_VEC2, glm::value_ptr(val), sizeof(val)))
+		glProgramUniform2fv(ID, u->location, 1, glm::value_ptr(val));
+}
+
+void ShaderProgram::setUniform(UniformId id, const glm::vec3 val) {
+	if (const auto* u = prepare_upload(id, GL_FLOAT_VEC3, glm::value_ptr(val), sizeof(val)))
+		glProgramUniform3fv(ID, u->location, 1, glm::value_ptr(val));
+}
+
+void ShaderProgram::setUniform(UniformId id, const glm::vec4 val) {
+	if (const auto* u = prepare_upload(id, GL_FLOAT_VEC4, glm::value_ptr(val), sizeof(val)))
+		glProgramUniform4fv(ID, u->location, 1, glm::value_ptr(val));
+}
+
+void ShaderProgram::setUniform(UniformId id, const glm::mat3 val) {
+	if (const auto* u = prepare_upload(id, GL_FLOAT_MAT3, glm::value_ptr(val), sizeof(val)))
+		glProgramUniformMatrix3fv(ID, u->location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+void ShaderProgram::setUniform(UniformId id, const glm::mat4 val) {
+	if (const auto* u = prepare_upload(id, GL_FLOAT_MAT4, glm::value_ptr(val), sizeof(val)))
+		glProgramUniformMatrix4fv(ID, u->location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+ShaderProgram::UniformSlot* ShaderProgram::prepare_upload(UniformId id, GLenum type, const void* data, std::size_t size) {
+	finish();
+	UniformSlot* slot = find_uniform(id.hash);
+	if (slot == nullptr) {
+		// a variant may compile out code that uses it
+		if (m_defines.empty())
+			std::cerr << "no uniform with name:" << id.name << '\n';
+		return nullptr;
+	}
+
+	// ints also set bools and samplers
+	const bool type_ok = slot->type == type ||
+		(type == GL_INT && slot->type != GL_FLOAT && slot->type != GL_DOUBLE &&
+		 slot->type != GL_FLOAT_VEC2 && slot->type != GL_FLOAT_VEC3 && slot->type != GL_FLOAT_VEC4 &&
+		 slot->type != GL_FLOAT_MAT3 && slot->type != GL_FLOAT_MAT4);
+	if (!type_ok || size > slot->shadow_size) {
+		std::cerr << "uniform type mismatch:" << id.name << '\n';
+		return nullptr;
+	}
+
+	std::byte* shadow = m_shadow.data() + slot->shadow_offset;
+	if (slot->shadow_valid && std::memcmp(shadow, data, size) == 0) {
+		++m_skipped;
+		return nullptr;
+	}
+
+	std::memcpy(shadow, data, size);
+	slot->shadow_valid = true;
+	++m_uploads;
+	return slot;
+}
+
+ShaderProgram::UniformSlot* ShaderProgram::find_uniform(std::uint64_t hash) {
+	if (m_uniforms.empty())
+		return nullptr;
+
+	const std::size_t mask = m_uniforms.size() - 1;
+	for (std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+		if (m_uniforms[i].hash == hash)
+			return &m_uniforms[i];
+		if (m_uniforms[i].hash == 0)
+			return nullptr;
+	}
+}
+
+void ShaderProgram::insert_uniform(std::uint64_t hash, GLint location, GLenum type) {
+	const std::size_t mask = m_uniforms.size() - 1;
+	std::size_t i = hash & mask;
+	while (m_uniforms[i].hash != 0 && m_uniforms[i].hash != hash)
+		i = (i + 1) & mask;
+
+	UniformSlot& slot = m_uniforms[i];
+	slot.hash = hash;
+	slot.location = location;
+	slot.type = type;
+	slot.shadow_offset = static_cast<std::uint32_t>(m_shadow.size());
+	slot.shadow_size = sizeof(glm::mat4); // largest supported value
+	slot.shadow_valid = false;
+	m_shadow.resize(m_shadow.size() + slot.shadow_size);
+}
+
+void ShaderProgram::restore_uniforms(const std::vector<UniformSlot>& slots, const std::vector<std::byte>& shadow) {
+	for (const UniformSlot& old : slots) {
+		if (old.hash == 0 || !old.shadow_valid)
+			continue;
+		UniformSlot* slot = find_uniform(old.hash);
+		if (slot == nullptr || slot->type != old.type)
+			continue;
+		const std::byte* value = shadow.data() + old.shadow_offset;
+		std::byte* current = m_shadow.data() + slot->shadow_offset;
+		if (slot->shadow_valid && std::memcmp(current, value, slot->shadow_size) == 0)
+			continue; // switching back to a variant only uploads what changed meanwhile
+		std::memcpy(current, value, slot->shadow_size);
+		slot->shadow_valid = true;
+		upload(*slot, value);
+	}
+}
+
+void ShaderProgram::upload(const UniformSlot& slot, const std::byte* value) {
+	const auto* f = reinterpret_cast<const GLfloat*>(value);
+	switch (slot.type) {
+	case GL_FLOAT: glProgramUniform1fv(ID, slot.location, 1, f); break;
+	case GL_DOUBLE: glProgramUniform1dv(ID, slot.location, 1, reinterpret_cast<const GLdouble*>(value)); break;
+	case GL_FLOAT_VEC2: glProgramUniform2fv(ID, slot.location, 1, f); break;
+	case GL_FLOAT_VEC3: glProgramUniform3fv(ID, slot.location, 1, f); break;
+	case GL_FLOAT_VEC4: glProgramUniform4fv(ID, slot.location, 1, f); break;
+	case GL_FLOAT_MAT3: glProgramUniformMatrix3fv(ID, slot.location, 1, GL_FALSE, f); break;
+	case GL_FLOAT_MAT4: glProgramUniformMatrix4fv(ID, slot.location, 1, GL_FALSE, f); break;
+	default: glProgramUniform1iv(ID, slot.location, 1, reinterpret_cast<const GLint*>(value)); break; // ints, bools, samplers
+	}
+}
+
+void ShaderProgram::reflect_uniforms() {
+	m_uniforms.clear();
+	m_shadow.clear();
+
+	GLint count = 0;
+	glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+	GLint max_name = 0;
+	glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name);
+
+	struct Active {
+		std::string name;
+		GLint location, type, array_size;
+	};
+	std::vector<Active> active;
+	std::size_t entries = 0;
+
+	const GLenum props[] = { GL_BLOCK_INDEX, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE };
+	std::vector<char> name_buf(static_cast<std::size_t>(std::max(max_name, 1)));
+	for (GLint i = 0; i < count; ++i) {
+		GLint values[4];
+		glGetProgramResourceiv(ID, GL_UNIFORM, i, 4, props, 4, nullptr, values);
+		if (values[0] != -1 || values[1] == -1)
+			continue; // member of uniform block, no location
+
+		GLsizei length = 0;
+		glGetProgramResourceName(ID, GL_UNIFORM, i, max_name, &length, name_buf.data());
+		active.push_back({ std::string(name_buf.data(), length), values[1], values[2], values[3] });
+		entries += 1 + static_cast<std::size_t>(values[3]);
+	}
+
+	// keep load factor <= 0.5
+	std::size_t capacity = 16;
+	while (capacity < entries * 2)
+		capacity *= 2;
+	m_uniforms.resize(capacity);
+
+	for (const auto& u : active) {
+		// arrays of basic types are reported as "name[0]", register "name" and every element
+		const auto bracket = u.name.size() > 3 ? u.name.rfind("[0]") : std::string::npos;
+		if (bracket != std::string::npos && bracket + 3 == u.name.size()) {
+			const std::string base = u.name.substr(0, bracket);
+			insert_uniform(UniformId::fnv1a(base), u.location, u.type);
+			for (GLint e = 0; e < u.array_size; ++e)
+				insert_uniform(UniformId::indexed(base, static_cast<unsigned>(e)).hash, u.location + e, u.type);
+		}
+		else {
+			insert_uniform(UniformId::fnv1a(u.name), u.location, u.type);
+		}
 	}
-	glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(val));
 }
 
 std::string ShaderProgram::getShaderInfoLog(const GLuint obj) {
@@ -118,30 +630,30 @@ std::string ShaderProgram::getProgramInfoLog(const GLuint obj) {
 
 }
 
-GLuint ShaderProgram::compile_shader(const std::filesystem::path& source_file, const GLenum type)
+GLuint ShaderProgram::compile_shader(const Stage& stage)
 {
 	GLuint shader_h;
-	shader_h = glCreateShader(type);
+	shader_h = glCreateShader(stage.type);
 	if (shader_h == 0) {
 		throw std::runtime_error("Failed to create shader.");
 	}
 
-	// Read shader source code
-	std::string source_code = textFileRead(source_file);
-	const char* source_ptr = source_code.c_str();
-
-	// Attach source and compile
-	glShaderSource(shader_h, 1, &source_ptr, nullptr);
-	glCompileShader(shader_h);
-
-	//glGetShaderiv()
-	GLint cmpl_status;
-	glGetShaderiv(shader_h, GL_COMPILE_STATUS, &cmpl_status);
-	if (cmpl_status == GL_FALSE) {
-		Logger::error("Shader compilation failed for " + std::string(source_file) + ":\n" + getShaderInfoLog(shader_h));
-		throw std::runtime_error("Shader compile err.\n");
+	if (stage.spirv) {
+		// pre-compiled module, specialization replaces the compile
+		glShaderBinary(1, &shader_h, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, stage.code.data(), static_cast<GLsizei>(stage.code.size()));
+		if (GLEW_VERSION_4_6)
+			glSpecializeShader(shader_h, "main", 0, nullptr, nullptr);
+		else
+			glSpecializeShaderARB(shader_h, "main", 0, nullptr, nullptr);
+	}
+	else {
+		// Attach source and compile
+		const char* source_ptr = stage.code.c_str();
+		glShaderSource(shader_h, 1, &source_ptr, nullptr);
+		glCompileShader(shader_h);
 	}
 
+	// no status query here, it would wait for the compile - finish_build checks it
 	return shader_h;
 }
 
@@ -151,18 +663,11 @@ GLuint ShaderProgram::link_shader(const std::vector<GLuint> shader_ids) {
 	for (auto const id : shader_ids) {
 		glAttachShader(prog_h, id);
 	}
+	if (binary_cache)
+		glProgramParameteri(prog_h, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
-	glLinkProgram(prog_h);
-
-	// check link result, display error (if any) ->done?
-	GLint status;
-	glGetProgramiv(prog_h, GL_LINK_STATUS, &status);
-	if (status == GL_FALSE) {
-		std::cerr << getProgramInfoLog(prog_h);
-		throw std::runtime_error("Link err.\n");
-	}
+	glLinkProgram(prog_h); // result checked in finish_build
 	return prog_h;
-	
 }
 
 std::string ShaderProgram::textFileRead(const std::filesystem::path & filename) {
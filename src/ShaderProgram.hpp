@@ -1,43 +1,207 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <utility>
 
 #include <GL/glew.h> 
+#include <glm/glm.hpp>
+
+#include "GLState.hpp"
+
+// uniform handle = FNV-1a hash of uniform name, resolvable at compile time: "uM_m"_u
+class UniformId {
+public:
+	constexpr explicit UniformId(std::string_view name) : hash(fnv1a(name)), name(name) {}
+
+	// element of uniform array, optionally struct member: indexed("teapotLight", 1, "position") == "teapotLight[1].position"
+	static constexpr UniformId indexed(std::string_view array, unsigned index, std::string_view member = {}) {
+		std::uint64_t h = fnv1a("[", fnv1a(array));
+		char digits[10]{};
+		int n = 0;
+		do {
+			digits[n++] = static_cast<char>('0' + index % 10);
+			index /= 10;
+		} while (index > 0);
+		while (n > 0)
+			h = fnv1a(std::string_view(&digits[--n], 1), h);
+		h = fnv1a("]", h);
+		if (!member.empty())
+			h = fnv1a(member, fnv1a(".", h));
+		return UniformId(h == 0 ? 1 : h, array);
+	}
+
+	static constexpr std::uint64_t fnv1a(std::string_view s, std::uint64_t h = 14695981039346656037ull) {
+		for (const char c : s) {
+			h ^= static_cast<std::uint8_t>(c);
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	std::uint64_t hash;
+	std::string_view name; // for diagnostics only, valid as long as the source string
+
+private:
+	constexpr UniformId(std::uint64_t hash, std::string_view name) : hash(hash), name(name) {}
+};
+
+consteval UniformId operator""_u(const char* name, std::size_t length) {
+	return UniformId(std::string_view(name, length));
+}
 
 class ShaderProgram {
 public:
+	// linked programs are saved as driver binaries (glGetProgramBinary) and restored on the next start
+	// key = stage sources + GL_VENDOR / GL_RENDERER / GL_VERSION, a rejected binary falls back to compiling
+	static constexpr std::uint32_t BINARY_VERSION = 1;
+	inline static bool binary_cache = true; // config shader_binary_cache
+	inline static std::filesystem::path cache_dir = "cache/programs";
+	// use <stage file>.spv (glslangValidator -G) instead of the GLSL text, needs GL_ARB_gl_spirv
+	// a module older than its GLSL source is ignored, SPIR-V shaders need explicit uniform locations
+	inline static bool spirv = false; // config shader_spirv
+
+	// compile and link are only issued, the driver builds many programs at once (GL_KHR_parallel_shader_compile)
+	// the first use waits for the result and throws on errors like a synchronous build
+	static void init_parallel_compile(); // once after glewInit
+
 	// you can add more constructors for pipeline with GS, TS etc.
 	ShaderProgram() = default; //does nothing
 	ShaderProgram(const std::filesystem::path & VS_file, const std::filesystem::path & FS_file);
-	void activate() { glUseProgram(ID); };    // activate shader
-	void deactivate() { glUseProgram(0); };   // deactivate current shader program (i.e. activate shader no. 0)
+	explicit ShaderProgram(const std::filesystem::path & CS_file); // compute shader
+	void activate() { finish(); GLState::use_program(ID); };    // activate shader
+	void deactivate() { GLState::use_program(0); };   // deactivate current shader program (i.e. activate shader no. 0)
+
+	bool ready() const { return m_pending.program == 0 || build_complete(m_pending); } // using it will not stall
+	void finish() { if (m_pending.program != 0) finish_pending(); } // wait for the first build
+
+	// compile time variants, "#define NAME VALUE" lines injected after #version
+	// every define set is its own GL program in a permutation cache, compiled on first select or by prewarm
+	using Defines = std::vector<std::pair<std::string, int>>;
+	void select(const Defines& defines); // ID and uniform table switch, values set so far are carried over
+	void prewarm(const Defines& defines); // only submits the build
+	bool ready(const Defines& defines) const; // selecting it will not stall
+	std::size_t variant_count() const { return m_variants.size() + 1; }
+
+	// live reload: rebuilt from the stage files, the new program replaces ID once the driver has linked it
+	// uniform values are carried over, a failed build keeps the old program, cached variants are rebuilt
+	bool uses(const std::filesystem::path & file) const; // stage file or its .spv
+	void reload();
+	bool update_reload(); // per frame, true when the new program was swapped in
 
 	void clear(void) { 	//deallocate shader program - dont put in destructor
 		deactivate();
+		discard(m_reload);
+		m_pending.program = 0; // == ID
+		discard(m_pending);
 		glDeleteProgram(ID);
 		ID = 0;
+		for (auto& [defines, variant] : m_variants) {
+			discard(variant.pending);
+			glDeleteProgram(variant.id);
+		}
+		m_variants.clear();
+		m_uniforms.clear();
+		m_shadow.clear();
 	}
     
-    // set uniform according to name 
-    // https://docs.gl/gl4/glUniform
-    void setUniform(const std::string & name, const float val);      
-    void setUniform(const std::string & name, const double val);
-	void setUniform(const std::string & name, const int val);
-    void setUniform(const std::string & name, const glm::vec3 val);  
-    void setUniform(const std::string & name, const glm::vec4 val);
-    void setUniform(const std::string & name, const glm::mat3 val);   
-    void setUniform(const std::string & name, const glm::mat4 val);
+    // set uniform according to handle, location is taken from table reflected at link time
+    // value is uploaded only when it differs from the last one (shadow copy)
+    // https://docs.gl/gl4/glProgramUniform
+    void setUniform(UniformId id, const float val);
+    void setUniform(UniformId id, const double val);
+	void setUniform(UniformId id, const int val);
+    void setUniform(UniformId id, const glm::vec2 val);
+    void setUniform(UniformId id, const glm::vec3 val);
+    void setUniform(UniformId id, const glm::vec4 val);
+    void setUniform(UniformId id, const glm::mat3 val);
+    void setUniform(UniformId id, const glm::mat4 val);
+
+    // set uniform according to name - hashed at runtime, prefer "name"_u handles
+    template<typename T>
+    void setUniform(std::string_view name, const T val) { setUniform(UniformId(name), val); }
+
+    // redundant upload statistics
+    std::uint64_t uniform_uploads() const noexcept { return m_uploads; }
+    std::uint64_t uniform_skipped() const noexcept { return m_skipped; }
     
 	GLuint ID{ 0 }; // default = 0, empty shader
 private:
+	// reflected active uniform, open addressing slot (hash == 0 means empty)
+	struct UniformSlot {
+		std::uint64_t hash = 0;
+		GLint location = -1;
+		GLenum type = 0;
+		std::uint32_t shadow_offset = 0;
+		std::uint32_t shadow_size = 0;
+		bool shadow_valid = false;
+	};
+
+	void reflect_uniforms();
+	void insert_uniform(std::uint64_t hash, GLint location, GLenum type);
+	UniformSlot* find_uniform(std::uint64_t hash);
+	// shadowed values of the previous program, uploaded to the current one where name and type match
+	void restore_uniforms(const std::vector<UniformSlot>& slots, const std::vector<std::byte>& shadow);
+	void upload(const UniformSlot& slot, const std::byte* value);
+
+	// null when uniform does not exist, has different type or value is unchanged
+	UniformSlot* prepare_upload(UniformId id, GLenum type, const void* data, std::size_t size);
+
+	std::vector<UniformSlot> m_uniforms; // power of two capacity
+	std::vector<std::byte> m_shadow;     // last uploaded values
+	std::uint64_t m_uploads = 0;
+	std::uint64_t m_skipped = 0;
 	
 	std::string getShaderInfoLog(const GLuint obj);
 	std::string getProgramInfoLog(const GLuint obj);
 
-	GLuint compile_shader(const std::filesystem::path & source_file, const GLenum type);
+	struct Stage {
+		std::filesystem::path file;
+		GLenum type;
+		std::string code; // GLSL text or SPIR-V module
+		bool spirv = false;
+	};
+
+	// program handed to the driver, statuses not queried yet
+	struct Build {
+		GLuint program = 0;
+		std::vector<GLuint> shaders; // empty when restored from a binary
+		std::vector<std::filesystem::path> files; // per shader, for the error log
+		std::uint64_t key = 0;
+		bool save_binary = false;
+	};
+
+	std::vector<std::pair<std::filesystem::path, GLenum>> m_files;
+	std::string m_name;
+	Build m_pending; // first build, ID until finished
+	Build m_reload;
+
+	// variant not selected right now, the selected one lives in ID / m_pending / m_uniforms / m_shadow
+	struct Variant {
+		GLuint id = 0;  // finished program
+		Build pending;  // or the build still in flight
+		std::vector<UniformSlot> uniforms;
+		std::vector<std::byte> shadow;
+	};
+	std::string m_defines; // define block of the selected variant, empty = plain source
+	std::unordered_map<std::string, Variant> m_variants;
+
+	static std::string define_block(Defines defines);
+	Build start_build(const std::string& defines);
+	static bool build_complete(const Build& build);
+	GLuint finish_build(Build& build); // throws on compile / link errors, objects are deleted then
+	static void discard(Build& build);
+	void finish_pending();
+
+	static std::uint64_t binary_key(const std::vector<Stage>& stages);
+	GLuint load_binary(std::uint64_t key);
+	void save_binary(GLuint program, std::uint64_t key);
+
+	GLuint compile_shader(const Stage & stage);
 	GLuint link_shader(const std::vector<GLuint> shader_ids);
     std::string textFileRead(const std::filesystem::path & filename);
 };
-
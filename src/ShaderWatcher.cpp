@@ -0,0 +1,92 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 5.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "ShaderWatcher.hpp"
+#include "Logger.hpp"
+
+#ifdef __linux__
+
+ShaderWatcher::ShaderWatcher(std::filesystem::path directory) : m_directory(std::move(directory)) {
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // editors either rewrite the file or rename a temporary over it
+    if (m_fd < 0 || inotify_add_watch(m_fd, m_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        Logger::warning("Shader watcher: cannot watch " + m_directory.string() + ": " + std::strerror(errno));
+        if (m_fd >= 0)
+            close(m_fd);
+        m_fd = -1;
+    }
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+std::vector<std::filesystem::path> ShaderWatcher::poll() {
+    std::vector<std::filesystem::path> changed;
+    if (m_fd < 0)
+        return changed;
+
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break; // EAGAIN, nothing more queued
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0) {
+                std::filesystem::path file = m_directory / event->name;
+                if (std::ranges::find(changed, file) == changed.end())
+                    changed.push_back(std::move(file));
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+    return changed;
+}
+
+#else
+
+ShaderWatcher::ShaderWatcher(std::filesystem::path directory) : m_directory(std::move(directory)) {
+    scan(nullptr);
+}
+
+ShaderWatcher::~ShaderWatcher() = default;
+
+std::vector<std::filesystem::path> ShaderWatcher::poll() {
+    std::vector<std::filesystem::path> changed;
+    const auto now = std::chrono::steady_clock::now();
+    if (now < m_next_scan)
+        return changed;
+    m_next_scan = now + std::chrono::milliseconds(500);
+    scan(&changed);
+    return changed;
+}
+
+void ShaderWatcher::scan(std::vector<std::filesystem::path>* changed) {
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_directory, ec)) {
+        if (!entry.is_regular_file(ec))
+            continue;
+        const auto time = entry.last_write_time(ec);
+        auto [it, inserted] = m_times.try_emplace(entry.path().string(), time);
+        if (!inserted && it->second != time) {
+            it->second = time;
+            if (changed)
+                changed->push_back(entry.path());
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,39 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 5.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef SHADERWATCHER_HPP
+#define SHADERWATCHER_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// files written in one directory (not recursive), for live shader reload
+// inotify on Linux, elsewhere modification times scanned twice a second
+class ShaderWatcher {
+public:
+    explicit ShaderWatcher(std::filesystem::path directory);
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // changed since the last call, each file once, never blocks
+    std::vector<std::filesystem::path> poll();
+
+private:
+    std::filesystem::path m_directory;
+#ifdef __linux__
+    int m_fd = -1;
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_times;
+    std::chrono::steady_clock::time_point m_next_scan{};
+    void scan(std::vector<std::filesystem::path>* changed);
+#endif
+};
+
+#endif //SHADERWATCHER_HPP
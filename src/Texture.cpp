@@ -1,16 +1,21 @@
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
 #include "Texture.hpp"
+#include "TextureBaker.hpp"
 
 
 GLuint textureInit(const std::filesystem::path& file_name) {
-	cv::Mat image = cv::imread(file_name.string(), cv::IMREAD_UNCHANGED);  // read with alpha
-	if (image.empty()) {
+	std::ifstream file(file_name, std::ios::binary);
+	if (!file) {
 		throw std::runtime_error("No texture in file: " + file_name.string());
 	}
+	const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 
-	GLuint texture = gen_tex(image);
-
-	return texture;
+	// baked mip chain (compressed if supported), cached on disk
+	return TextureBaker::upload(TextureBaker::load(bytes, file_name.string()));
 }
 
 GLuint gen_tex(cv::Mat& image) {
@@ -21,16 +26,17 @@ GLuint gen_tex(cv::Mat& image) {
 	}
 
 	glCreateTextures(GL_TEXTURE_2D, 1, &ID);
+	const auto levels = static_cast<GLsizei>(std::floor(std::log2(std::max(image.cols, image.rows)))) + 1; // full chain for glGenerateTextureMipmap
 
 	switch (image.channels()) {
 	case 3:
 		// Create and clear space for data - immutable format
-		glTextureStorage2D(ID, 1, GL_RGB8, image.cols, image.rows);
+		glTextureStorage2D(ID, levels, GL_RGB8, image.cols, image.rows);
 		// Assigns the image to the OpenGL Texture object
 		glTextureSubImage2D(ID, 0, 0, 0, image.cols, image.rows, GL_BGR, GL_UNSIGNED_BYTE, image.data);
 		break;
 	case 4:
-		glTextureStorage2D(ID, 1, GL_RGBA8, image.cols, image.rows);
+		glTextureStorage2D(ID, levels, GL_RGBA8, image.cols, image.rows);
 		glTextureSubImage2D(ID, 0, 0, 0, image.cols, image.rows, GL_BGRA, GL_UNSIGNED_BYTE, image.data);
 		break;
 	default:
@@ -10,10 +10,10 @@
 #include <GL/glew.h>
 #include <filesystem>
 
-// generate GL texture from image file
+// generate GL texture from image file, through the TextureBaker cache
 GLuint textureInit(const std::filesystem::path& file_name);
 
-// generate GL texture from OpenCV image
+// generate GL texture from OpenCV image, uncompressed, mipmaps generated by the driver
 GLuint gen_tex(cv::Mat& image);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,596 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 1.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define TEXTUREBAKER_SSE 1
+#endif
+
+#include "TextureBaker.hpp"
+#include "Logger.hpp"
+#include "ResourceManager.hpp"
+
+namespace {
+    using Block = std::array<std::uint8_t, 64>; // 4x4 RGBA8
+
+    // linear RGBA float image
+    struct Image {
+        int width = 0, height = 0;
+        std::vector<float> pixels;
+    };
+
+    // rows [0, rows) split over the hardware threads, f(begin, end)
+    // a pool thread already shares the cores with the other bakes, it does all rows itself
+    template <typename F>
+    void parallel_rows(int rows, const F& f) {
+        if (TextureBaker::pool_thread) {
+            f(0, rows);
+            return;
+        }
+        const int workers = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, std::max(rows / 8, 1));
+        const int step = (rows + workers - 1) / workers;
+        std::vector<std::thread> threads;
+        for (int begin = step; begin < rows; begin += step)
+            threads.emplace_back(f, begin, std::min(begin + step, rows));
+        f(0, std::min(step, rows));
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    const std::array<float, 256>& srgb_to_linear() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> t{};
+            for (int i = 0; i < 256; ++i) {
+                const float c = static_cast<float>(i) / 255.0f;
+                t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    std::uint8_t linear_to_srgb(float c) {
+        c = std::clamp(c, 0.0f, 1.0f);
+        const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return static_cast<std::uint8_t>(s * 255.0f + 0.5f);
+    }
+
+    Image to_linear(const cv::Mat& rgba) {
+        Image image{rgba.cols, rgba.rows, std::vector<float>(rgba.total() * 4)};
+        const auto& table = srgb_to_linear();
+        parallel_rows(image.height, [&](int begin, int end) {
+            for (int y = begin; y < end; ++y) {
+                const std::uint8_t* src = rgba.ptr(y);
+                float* dst = &image.pixels[static_cast<size_t>(y) * image.width * 4];
+                for (int i = 0; i < image.width * 4; i += 4) {
+                    dst[i + 0] = table[src[i + 0]];
+                    dst[i + 1] = table[src[i + 1]];
+                    dst[i + 2] = table[src[i + 2]];
+                    dst[i + 3] = static_cast<float>(src[i + 3]) / 255.0f;
+                }
+            }
+        });
+        return image;
+    }
+
+    // 2x2 box filter, odd last row / column is dropped
+    Image downsample(const Image& src) {
+        Image dst{std::max(src.width / 2, 1), std::max(src.height / 2, 1), {}};
+        dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+        parallel_rows(dst.height, [&](int begin, int end) {
+            for (int y = begin; y < end; ++y) {
+                const float* row0 = &src.pixels[static_cast<size_t>(std::min(2 * y, src.height - 1)) * src.width * 4];
+                const float* row1 = &src.pixels[static_cast<size_t>(std::min(2 * y + 1, src.height - 1)) * src.width * 4];
+                float* out = &dst.pixels[static_cast<size_t>(y) * dst.width * 4];
+                for (int x = 0; x < dst.width; ++x, out += 4) {
+                    const size_t x0 = static_cast<size_t>(std::min(2 * x, src.width - 1)) * 4;
+                    const size_t x1 = static_cast<size_t>(std::min(2 * x + 1, src.width - 1)) * 4;
+#ifdef TEXTUREBAKER_SSE
+                    // one RGBA pixel per register
+                    const __m128 top = _mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1));
+                    const __m128 bottom = _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1));
+                    _mm_storeu_ps(out, _mm_mul_ps(_mm_add_ps(top, bottom), _mm_set1_ps(0.25f)));
+#else
+                    for (size_t c = 0; c < 4; ++c)
+                        out[c] = 0.25f * (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]);
+#endif
+                }
+            }
+        });
+        return dst;
+    }
+
+    cv::Mat to_rgba8(const Image& image) {
+        cv::Mat rgba(image.height, image.width, CV_8UC4);
+        parallel_rows(image.height, [&](int begin, int end) {
+            for (int y = begin; y < end; ++y) {
+                const float* src = &image.pixels[static_cast<size_t>(y) * image.width * 4];
+                std::uint8_t* dst = rgba.ptr(y);
+                for (int i = 0; i < image.width * 4; i += 4) {
+                    dst[i + 0] = linear_to_srgb(src[i + 0]);
+                    dst[i + 1] = linear_to_srgb(src[i + 1]);
+                    dst[i + 2] = linear_to_srgb(src[i + 2]);
+                    dst[i + 3] = static_cast<std::uint8_t>(std::clamp(src[i + 3], 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        });
+        return rgba;
+    }
+
+    // principal axis of the block colors (power iteration on the covariance), N = 3 (RGB) or 4 (RGBA)
+    // returns the pixels with the smallest and largest projection
+    template <int N>
+    std::pair<int, int> principal_extremes(const Block& block) {
+        float mean[N]{};
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < N; ++c)
+                mean[c] += block[i * 4 + c] / 16.0f;
+
+        float cov[N][N]{};
+        float lo[N], hi[N];
+        std::fill_n(lo, N, 255.0f);
+        std::fill_n(hi, N, 0.0f);
+        for (int i = 0; i < 16; ++i) {
+            float d[N];
+            for (int c = 0; c < N; ++c) {
+                d[c] = block[i * 4 + c] - mean[c];
+                lo[c] = std::min(lo[c], static_cast<float>(block[i * 4 + c]));
+                hi[c] = std::max(hi[c], static_cast<float>(block[i * 4 + c]));
+            }
+            for (int r = 0; r < N; ++r)
+                for (int c = 0; c < N; ++c)
+                    cov[r][c] += d[r] * d[c];
+        }
+
+        float axis[N];
+        for (int c = 0; c < N; ++c)
+            axis[c] = hi[c] - lo[c];
+        for (int iteration = 0; iteration < 4; ++iteration) {
+            float next[N]{};
+            float length = 0.0f;
+            for (int r = 0; r < N; ++r) {
+                for (int c = 0; c < N; ++c)
+                    next[r] += cov[r][c] * axis[c];
+                length = std::max(length, std::abs(next[r]));
+            }
+            if (length < 1e-6f)
+                break; // flat block, keep the bounding box diagonal
+            for (int c = 0; c < N; ++c)
+                axis[c] = next[c] / length;
+        }
+
+        int min_i = 0, max_i = 0;
+        float min_d = std::numeric_limits<float>::max(), max_d = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < 16; ++i) {
+            float d = 0.0f;
+            for (int c = 0; c < N; ++c)
+                d += block[i * 4 + c] * axis[c];
+            if (d < min_d) { min_d = d; min_i = i; }
+            if (d > max_d) { max_d = d; max_i = i; }
+        }
+        return {min_i, max_i};
+    }
+
+    std::uint16_t pack565(const float (&rgb)[3]) {
+        const auto q = [](float v, int max) { return static_cast<std::uint16_t>(std::clamp(static_cast<int>(v * max / 255.0f + 0.5f), 0, max)); };
+        return static_cast<std::uint16_t>(q(rgb[0], 31) << 11 | q(rgb[1], 63) << 5 | q(rgb[2], 31));
+    }
+
+    std::array<int, 3> unpack565(std::uint16_t c) {
+        const int r = c >> 11 & 31, g = c >> 5 & 63, b = c & 31;
+        return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+    }
+
+    // BC1 color block, always in 4 color mode (BC3 ignores the endpoint order anyway)
+    void encode_color(const Block& block, unsigned char* out) {
+        const auto [min_i, max_i] = principal_extremes<3>(block);
+        float e0[3], e1[3];
+        for (int c = 0; c < 3; ++c) {
+            // inset by 1/16 of the range, end points are rarely hit exactly
+            const float inset = (block[max_i * 4 + c] - block[min_i * 4 + c]) / 16.0f;
+            e0[c] = block[max_i * 4 + c] - inset;
+            e1[c] = block[min_i * 4 + c] + inset;
+        }
+        std::uint16_t c0 = pack565(e0), c1 = pack565(e1);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        std::uint32_t indices = 0;
+        if (c0 != c1) {
+            const auto p0 = unpack565(c0), p1 = unpack565(c1);
+            std::array<std::array<int, 3>, 4> palette{p0, p1};
+            for (int c = 0; c < 3; ++c) {
+                palette[2][c] = (2 * p0[c] + p1[c]) / 3;
+                palette[3][c] = (p0[c] + 2 * p1[c]) / 3;
+            }
+            for (int i = 0; i < 16; ++i) {
+                int best = 0, best_error = std::numeric_limits<int>::max();
+                for (int p = 0; p < 4; ++p) {
+                    int error = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        const int d = block[i * 4 + c] - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < best_error) { best_error = error; best = p; }
+                }
+                indices |= static_cast<std::uint32_t>(best) << (2 * i);
+            }
+        }
+        out[0] = static_cast<unsigned char>(c0); out[1] = static_cast<unsigned char>(c0 >> 8);
+        out[2] = static_cast<unsigned char>(c1); out[3] = static_cast<unsigned char>(c1 >> 8);
+        for (int b = 0; b < 4; ++b)
+            out[4 + b] = static_cast<unsigned char>(indices >> (8 * b));
+    }
+
+    // BC3 alpha block, 8 value mode (a0 > a1)
+    void encode_alpha(const Block& block, unsigned char* out) {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; ++i) {
+            a0 = std::max(a0, static_cast<int>(block[i * 4 + 3]));
+            a1 = std::min(a1, static_cast<int>(block[i * 4 + 3]));
+        }
+        out[0] = static_cast<unsigned char>(a0);
+        out[1] = static_cast<unsigned char>(a1);
+
+        std::uint64_t indices = 0;
+        if (a0 != a1) {
+            int palette[8] = {a0, a1};
+            for (int k = 2; k < 8; ++k)
+                palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+            for (int i = 0; i < 16; ++i) {
+                int best = 0;
+                for (int k = 1; k < 8; ++k)
+                    if (std::abs(block[i * 4 + 3] - palette[k]) < std::abs(block[i * 4 + 3] - palette[best]))
+                        best = k;
+                indices |= static_cast<std::uint64_t>(best) << (3 * i);
+            }
+        }
+        for (int b = 0; b < 6; ++b)
+            out[2 + b] = static_cast<unsigned char>(indices >> (8 * b));
+    }
+
+    // BC7 mode 6: 7 bit RGBA endpoints + one p-bit each, 16 interpolated values
+    void encode_bc7(const Block& block, unsigned char* out) {
+        static constexpr int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        const auto [min_i, max_i] = principal_extremes<4>(block);
+        int q[2][4], p[2];
+        for (int e = 0; e < 2; ++e) {
+            const int source = e == 0 ? min_i : max_i;
+            int best_error = std::numeric_limits<int>::max();
+            for (int bit = 0; bit < 2; ++bit) {
+                int candidate[4], error = 0;
+                for (int c = 0; c < 4; ++c) {
+                    const int v = block[source * 4 + c];
+                    candidate[c] = std::clamp((v - bit + 1) / 2, 0, 127);
+                    const int d = v - (candidate[c] << 1 | bit);
+                    error += d * d;
+                }
+                if (error < best_error) {
+                    best_error = error;
+                    p[e] = bit;
+                    std::copy_n(candidate, 4, q[e]);
+                }
+            }
+        }
+
+        int palette[16][4];
+        for (int k = 0; k < 16; ++k)
+            for (int c = 0; c < 4; ++c)
+                palette[k][c] = ((64 - weights[k]) * (q[0][c] << 1 | p[0]) + weights[k] * (q[1][c] << 1 | p[1]) + 32) >> 6;
+        int indices[16];
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, best_error = std::numeric_limits<int>::max();
+            for (int k = 0; k < 16; ++k) {
+                int error = 0;
+                for (int c = 0; c < 4; ++c) {
+                    const int d = block[i * 4 + c] - palette[k][c];
+                    error += d * d;
+                }
+                if (error < best_error) { best_error = error; best = k; }
+            }
+            indices[i] = best;
+        }
+
+        // the anchor (first) index is stored with 3 bits, its high bit must be 0
+        if (indices[0] & 8) {
+            std::swap(q[0], q[1]);
+            std::swap(p[0], p[1]);
+            for (int& index : indices)
+                index = 15 - index;
+        }
+
+        std::memset(out, 0, 16);
+        int position = 0;
+        const auto put = [&](std::uint32_t value, int bits) {
+            for (int b = 0; b < bits; ++b, ++position)
+                if (value >> b & 1)
+                    out[position >> 3] |= static_cast<unsigned char>(1 << (position & 7));
+        };
+        put(1u << 6, 7); // mode 6
+        for (int c = 0; c < 4; ++c) {
+            put(static_cast<std::uint32_t>(q[0][c]), 7);
+            put(static_cast<std::uint32_t>(q[1][c]), 7);
+        }
+        put(static_cast<std::uint32_t>(p[0]), 1);
+        put(static_cast<std::uint32_t>(p[1]), 1);
+        put(static_cast<std::uint32_t>(indices[0]), 3);
+        for (int i = 1; i < 16; ++i)
+            put(static_cast<std::uint32_t>(indices[i]), 4);
+    }
+
+    size_t block_bytes(TextureBaker::Format format) {
+        return format == TextureBaker::Format::BC1 ? 8 : 16;
+    }
+
+    // one level into baked.data
+    void encode(const cv::Mat& rgba, TextureBaker::Baked& baked) {
+        TextureBaker::Level level{static_cast<std::uint32_t>(rgba.cols), static_cast<std::uint32_t>(rgba.rows), baked.data.size(), 0};
+        if (baked.format == TextureBaker::Format::RGBA8) {
+            level.size = rgba.total() * 4;
+            baked.data.insert(baked.data.end(), rgba.data, rgba.data + level.size);
+            baked.levels.push_back(level);
+            return;
+        }
+
+        const int blocks_x = (rgba.cols + 3) / 4, blocks_y = (rgba.rows + 3) / 4;
+        const size_t bytes = block_bytes(baked.format);
+        level.size = static_cast<std::uint64_t>(blocks_x) * blocks_y * bytes;
+        baked.data.resize(baked.data.size() + level.size);
+        unsigned char* out = baked.data.data() + level.offset;
+
+        parallel_rows(blocks_y, [&](int begin, int end) {
+            Block block{};
+            for (int by = begin; by < end; ++by) {
+                for (int bx = 0; bx < blocks_x; ++bx) {
+                    // edge blocks of small levels repeat the last row / column
+                    for (int y = 0; y < 4; ++y) {
+                        const std::uint8_t* row = rgba.ptr(std::min(by * 4 + y, rgba.rows - 1));
+                        for (int x = 0; x < 4; ++x)
+                            std::memcpy(&block[(y * 4 + x) * 4], row + std::min(bx * 4 + x, rgba.cols - 1) * 4, 4);
+                    }
+                    unsigned char* dst = out + (static_cast<size_t>(by) * blocks_x + bx) * bytes;
+                    switch (baked.format) {
+                    case TextureBaker::Format::BC1: encode_color(block, dst); break;
+                    case TextureBaker::Format::BC3: encode_alpha(block, dst); encode_color(block, dst + 8); break;
+                    default: encode_bc7(block, dst); break;
+                    }
+                }
+            }
+        });
+        baked.levels.push_back(level);
+    }
+
+    const char* format_name(TextureBaker::Format format) {
+        switch (format) {
+        case TextureBaker::Format::BC1: return "BC1";
+        case TextureBaker::Format::BC3: return "BC3";
+        case TextureBaker::Format::BC7: return "BC7";
+        default: return "RGBA8";
+        }
+    }
+
+    // requested compression, downgraded to what the driver supports - part of the cache key
+    TextureBaker::Format target_format() {
+        if (TextureBaker::compress && TextureBaker::bc7 && (GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc))
+            return TextureBaker::Format::BC7;
+        if (TextureBaker::compress && GLEW_EXT_texture_compression_s3tc)
+            return TextureBaker::Format::BC1; // BC3 if the image has alpha
+        return TextureBaker::Format::RGBA8;
+    }
+
+    struct CacheHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t key;
+        std::uint32_t format;
+        std::uint32_t level_count;
+    };
+}
+
+TextureBaker::Baked TextureBaker::load(const std::vector<unsigned char>& bytes, const std::string& name, std::uint32_t layer_size) {
+    const Format target = layer_size > 0 ? layer_format() : target_format();
+    std::uint64_t key = ResourceManager::hash(bytes.data(), bytes.size());
+    key = ResourceManager::hash(&VERSION, sizeof(VERSION), key);
+    key = ResourceManager::hash(&target, sizeof(target), key);
+    if (layer_size > 0)
+        key = ResourceManager::hash(&layer_size, sizeof(layer_size), key);
+
+    char file_name[32];
+    std::snprintf(file_name, sizeof(file_name), "%016llx.btex", static_cast<unsigned long long>(key));
+    const std::filesystem::path path = cache_dir / file_name;
+
+    Baked baked;
+    if (read_cache(path, key, baked))
+        return baked;
+
+    cv::Mat image = cv::imdecode(bytes, cv::IMREAD_UNCHANGED);
+    if (image.empty())
+        throw std::runtime_error("No texture in file: " + name);
+
+    const auto start = std::chrono::steady_clock::now();
+    baked = bake(image, layer_size);
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    Logger::info("Texture bake: " + name + " " + std::to_string(image.cols) + "x" + std::to_string(image.rows) + " "
+                 + format_name(baked.format) + ", " + std::to_string(baked.levels.size()) + " levels, "
+                 + std::to_string(baked.data.size() / 1024) + " KiB, " + std::to_string(ms) + " ms");
+
+    write_cache(path, key, baked);
+    return baked;
+}
+
+TextureBaker::Baked TextureBaker::bake(const cv::Mat& image, std::uint32_t layer_size) {
+    cv::Mat rgba;
+    switch (image.channels()) {
+    case 1: cv::cvtColor(image, rgba, cv::COLOR_GRAY2RGBA); break;
+    case 3: cv::cvtColor(image, rgba, cv::COLOR_BGR2RGBA); break;
+    case 4: cv::cvtColor(image, rgba, cv::COLOR_BGRA2RGBA); break;
+    default:
+        throw std::runtime_error("unsupported channel cnt. in texture:" + std::to_string(image.channels()));
+    }
+
+    Baked baked;
+    baked.format = target_format();
+    if (layer_size > 0) {
+        const auto size = static_cast<int>(layer_size);
+        if (rgba.cols != size || rgba.rows != size)
+            cv::resize(rgba, rgba, cv::Size(size, size), 0, 0, rgba.cols > size ? cv::INTER_AREA : cv::INTER_CUBIC);
+        baked.format = layer_format();
+    }
+    if (baked.format == Format::BC1) {
+        for (int y = 0; y < rgba.rows && baked.format == Format::BC1; ++y) {
+            const std::uint8_t* row = rgba.ptr(y);
+            for (int x = 0; x < rgba.cols; ++x)
+                if (row[x * 4 + 3] != 255) {
+                    baked.format = Format::BC3;
+                    break;
+                }
+        }
+    }
+
+    // level 0 as is, the rest filtered in linear space and encoded back to sRGB
+    encode(rgba, baked);
+    Image level = to_linear(rgba);
+    while (level.width > 1 || level.height > 1) {
+        level = downsample(level);
+        encode(to_rgba8(level), baked);
+    }
+    return baked;
+}
+
+GLuint TextureBaker::upload(const Baked& baked) {
+    if (baked.levels.empty())
+        throw std::runtime_error("Baked texture without levels");
+
+    const GLenum internal = internal_format(baked.format);
+    GLuint ID = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &ID);
+    glTextureStorage2D(ID, static_cast<GLsizei>(baked.levels.size()), internal,
+                       static_cast<GLsizei>(baked.levels[0].width), static_cast<GLsizei>(baked.levels[0].height));
+    for (size_t i = 0; i < baked.levels.size(); ++i) {
+        const Level& level = baked.levels[i];
+        const unsigned char* data = baked.data.data() + level.offset;
+        if (baked.format == Format::RGBA8)
+            glTextureSubImage2D(ID, static_cast<GLint>(i), 0, 0, static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height),
+                                GL_RGBA, GL_UNSIGNED_BYTE, data);
+        else
+            glCompressedTextureSubImage2D(ID, static_cast<GLint>(i), 0, 0, static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height),
+                                          internal, static_cast<GLsizei>(level.size), data);
+    }
+
+    glTextureParameteri(ID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(ID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(ID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    return ID;
+}
+
+void TextureBaker::upload_layer(GLuint array, GLint layer, const Baked& baked, GLint first_level) {
+    const GLenum internal = internal_format(baked.format);
+    for (size_t i = 0; i < baked.levels.size(); ++i) {
+        const Level& level = baked.levels[i];
+        const unsigned char* data = baked.data.data() + level.offset;
+        if (baked.format == Format::RGBA8)
+            glTextureSubImage3D(array, first_level + static_cast<GLint>(i), 0, 0, layer, static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height), 1,
+                                GL_RGBA, GL_UNSIGNED_BYTE, data);
+        else
+            glCompressedTextureSubImage3D(array, first_level + static_cast<GLint>(i), 0, 0, layer, static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height), 1,
+                                          internal, static_cast<GLsizei>(level.size), data);
+    }
+}
+
+TextureBaker::Baked TextureBaker::placeholder() {
+    unsigned char pixel[4] = {0, 0, 0, 255};
+    return bake(cv::Mat(1, 1, CV_8UC4, pixel), 1);
+}
+
+TextureBaker::Format TextureBaker::layer_format() {
+    const Format format = target_format();
+    return format == Format::BC1 ? Format::BC3 : format;
+}
+
+GLenum TextureBaker::internal_format(Format format) noexcept {
+    switch (format) {
+    case Format::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case Format::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case Format::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default: return GL_RGBA8;
+    }
+}
+
+bool TextureBaker::read_cache(const std::filesystem::path& path, std::uint64_t key, Baked& baked) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    CacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, "BTEX", 4) != 0 || header.version != VERSION || header.key != key
+        || header.format > static_cast<std::uint32_t>(Format::BC7) || header.level_count == 0 || header.level_count > 32) {
+        Logger::warning("Texture cache: ignoring invalid " + path.string());
+        return false;
+    }
+
+    baked.format = static_cast<Format>(header.format);
+    baked.levels.resize(header.level_count);
+    file.read(reinterpret_cast<char*>(baked.levels.data()), static_cast<std::streamsize>(baked.levels.size() * sizeof(Level)));
+    std::uint64_t size = 0;
+    for (const Level& level : baked.levels) {
+        if (!file || level.offset != size || level.size > (std::uint64_t{1} << 32)) {
+            Logger::warning("Texture cache: ignoring invalid " + path.string());
+            baked = {};
+            return false;
+        }
+        size += level.size;
+    }
+    baked.data.resize(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(baked.data.data()), static_cast<std::streamsize>(baked.data.size()));
+    if (!file) {
+        Logger::warning("Texture cache: truncated " + path.string());
+        baked = {};
+        return false;
+    }
+    return true;
+}
+
+void TextureBaker::write_cache(const std::filesystem::path& path, std::uint64_t key, const Baked& baked) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // written aside and renamed, a concurrent bake of the same key or a crash never leaves a partial file
+    const CacheHeader header{{'B', 'T', 'E', 'X'}, VERSION, key, static_cast<std::uint32_t>(baked.format),
+                             static_cast<std::uint32_t>(baked.levels.size())};
+    std::filesystem::path temp = path;
+    temp += "." + std::to_string(std::random_device{}()) + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(baked.levels.data()), static_cast<std::streamsize>(baked.levels.size() * sizeof(Level)));
+        file.write(reinterpret_cast<const char*>(baked.data.data()), static_cast<std::streamsize>(baked.data.size()));
+        if (!file) {
+            Logger::warning("Texture cache: cannot write " + path.string());
+            file.close();
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        Logger::warning("Texture cache: cannot write " + path.string() + ": " + ec.message());
+        std::filesystem::remove(temp, ec);
+    }
+}
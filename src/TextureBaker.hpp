@@ -0,0 +1,66 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 1.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef TEXTUREBAKER_HPP
+#define TEXTUREBAKER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <GL/glew.h>
+
+// offline texture bake, textures are uploaded with all levels and never use glGenerateTextureMipmap
+// - mip chain filtered in linear space (sRGB decoded, 2x2 box), rows split over threads unless baked on a pool thread
+// - block compression: BC1 opaque / BC3 with alpha, or BC7 (mode 6) for both
+// - result cached in cache_dir, file name = hash of the source bytes + bake settings
+class TextureBaker {
+public:
+    enum class Format : std::uint32_t {
+        RGBA8 = 0, // uncompressed, compression disabled or unsupported
+        BC1 = 1,   // 4 bpp, opaque
+        BC3 = 2,   // 8 bpp, BC1 color + interpolated alpha
+        BC7 = 3,   // 8 bpp, mode 6 only (one subset, 4 bit indices, RGBA endpoints)
+    };
+
+    struct Level {
+        std::uint32_t width = 0, height = 0;
+        std::uint64_t offset = 0, size = 0; // into Baked::data
+    };
+
+    struct Baked {
+        Format format = Format::RGBA8;
+        std::vector<Level> levels; // level 0 first
+        std::vector<unsigned char> data;
+    };
+
+    static constexpr std::uint32_t VERSION = 1; // bump when the encoders change, invalidates the cache
+
+    inline static bool compress = true; // config texture_compression != "none"
+    inline static bool bc7 = false;     // config texture_compression == "bc7"
+    inline static std::filesystem::path cache_dir = "cache/textures";
+    // set on worker pool threads (TextureStreamer, startup prefetch), their bakes run single threaded
+    inline static thread_local bool pool_thread = false;
+
+    // encoded image file (png, jpg...) -> cached bake, baked and written on a cache miss
+    // layer_size > 0: square texture array layer of that size in layer_format()
+    static Baked load(const std::vector<unsigned char>& bytes, const std::string& name, std::uint32_t layer_size = 0);
+
+    static Baked bake(const cv::Mat& image, std::uint32_t layer_size = 0); // 8 bit gray, BGR or BGRA, format from compress / bc7 and the alpha channel
+    static GLuint upload(const Baked& baked); // immutable storage, all levels
+    // into existing array storage of the same shape, baked level 0 goes to first_level
+    static void upload_layer(GLuint array, GLint layer, const Baked& baked, GLint first_level = 0);
+    static Baked placeholder(); // 1x1 opaque black in layer_format()
+
+    static GLenum internal_format(Format format) noexcept;
+    static Format layer_format(); // one format for every layer of an array, alpha capable
+
+private:
+    static bool read_cache(const std::filesystem::path& path, std::uint64_t key, Baked& baked);
+    static void write_cache(const std::filesystem::path& path, std::uint64_t key, const Baked& baked);
+};
+
+#endif //TEXTUREBAKER_HPP
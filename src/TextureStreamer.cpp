@@ -0,0 +1,407 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 2.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "TextureStreamer.hpp"
+#include "Logger.hpp"
+#include "TextureBaker.hpp"
+
+namespace {
+    constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    struct Job {
+        GLuint texture;
+        std::uint64_t ticket; // tells a cancelled texture from a new one with a reused name
+        std::vector<unsigned char> bytes;
+        std::string name;
+        std::int32_t layer = -1; // >= 0 for an array layer
+        std::uint32_t layer_size = 0;
+    };
+
+    // one level ready for upload, level_count == 0 = decode failed
+    struct Staged {
+        GLuint texture = 0;
+        std::uint64_t ticket = 0;
+        std::int32_t layer = -1;
+        TextureBaker::Format format = TextureBaker::Format::RGBA8;
+        std::uint32_t level = 0, level_count = 0;
+        std::uint32_t width = 0, height = 0;           // this level
+        std::uint32_t base_width = 0, base_height = 0; // level 0, for the storage
+        size_t offset = NONE, size = 0;                // staging buffer range
+        std::vector<unsigned char> client;             // level larger than the staging buffer
+    };
+
+    // staging allocation, freed in allocation order once its upload fence signaled
+    struct Region {
+        size_t offset = 0, size = 0;
+        bool done = false;
+        GLsync fence = nullptr;
+    };
+
+    struct Stream {
+        std::uint64_t ticket = 0;
+        std::uint32_t base_level = 0; // finest level uploaded
+        bool allocated = false;
+        std::string name;
+        std::uint32_t level_count = 0; // array layer, levels of the array storage
+    };
+
+    // shared with the workers
+    std::mutex s_mutex;
+    std::condition_variable s_work_ready;
+    std::condition_variable s_space_ready;
+    std::deque<Job> s_jobs;
+    std::vector<Staged> s_staged;
+    std::deque<Region> s_regions;
+    size_t s_head = 0;
+    bool s_stop = false;
+    std::vector<std::thread> s_workers;
+    unsigned char* s_mapped = nullptr;
+
+    // GL thread only
+    GLuint s_pbo = 0;
+    size_t s_budget = 0;
+    std::uint64_t s_next_ticket = 0;
+    std::vector<Staged> s_queue; // heap, smallest level first
+    std::unordered_map<std::uint64_t, Stream> s_streams; // stream_key
+    std::unordered_map<GLuint, std::vector<std::uint32_t>> s_arrays; // finest level written per layer
+
+    std::uint64_t stream_key(GLuint texture, std::int32_t layer) {
+        return (static_cast<std::uint64_t>(texture) << 32) | static_cast<std::uint32_t>(layer + 1);
+    }
+
+    // one base level for all layers, a level is shown once every layer has it (placeholder 1x1 before that)
+    void set_layer_level(GLuint array, std::int32_t layer, std::uint32_t level) {
+        const auto it = s_arrays.find(array);
+        if (it == s_arrays.end())
+            return;
+        const std::uint32_t base = std::ranges::max(it->second);
+        it->second[layer] = level;
+        if (const std::uint32_t finest = std::ranges::max(it->second); finest != base)
+            glTextureParameteri(array, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(finest));
+    }
+
+    bool later(const Staged& a, const Staged& b) {
+        if (a.size != b.size)
+            return a.size > b.size;
+        if (a.ticket != b.ticket)
+            return a.ticket > b.ticket;
+        return a.level < b.level; // equal sized BC levels (1x1 .. 4x4), coarsest first
+    }
+
+    // ring allocation in the staging buffer, blocks until the GL thread frees enough space
+    size_t allocate(std::unique_lock<std::mutex>& lock, size_t size) {
+        size = (size + 255) & ~size_t{255};
+        for (;;) {
+            if (s_stop)
+                return NONE;
+            size_t offset = NONE;
+            if (s_regions.empty()) {
+                offset = 0;
+            } else {
+                const size_t tail = s_regions.front().offset;
+                if (s_head > tail) {
+                    if (s_head + size <= TextureStreamer::STAGING_SIZE)
+                        offset = s_head;
+                    else if (size <= tail)
+                        offset = 0; // wrap, the end of the buffer stays unused this round
+                } else if (s_head + size <= tail) {
+                    offset = s_head;
+                }
+            }
+            if (offset != NONE) {
+                s_regions.push_back({offset, size, false, nullptr});
+                s_head = offset + size;
+                return offset;
+            }
+            s_space_ready.wait(lock);
+        }
+    }
+
+    // caller holds s_mutex
+    void release(const Staged& staged, GLsync fence) {
+        if (staged.offset == NONE)
+            return;
+        const auto region = std::ranges::find(s_regions, staged.offset, &Region::offset);
+        if (region != s_regions.end()) {
+            region->done = true;
+            region->fence = fence;
+        }
+    }
+
+    void worker() {
+        TextureBaker::pool_thread = true; // the workers run in parallel, no nested fan-out
+        std::unique_lock lock(s_mutex);
+        for (;;) {
+            s_work_ready.wait(lock, [] { return s_stop || !s_jobs.empty(); });
+            if (s_stop)
+                return;
+            Job job = std::move(s_jobs.front());
+            s_jobs.pop_front();
+            lock.unlock();
+
+            TextureBaker::Baked baked;
+            try {
+                baked = TextureBaker::load(job.bytes, job.name, job.layer_size);
+            } catch (const std::exception& e) {
+                Logger::error("Texture streaming: " + std::string(e.what()));
+            }
+
+            lock.lock();
+            if (baked.levels.empty()) {
+                s_staged.push_back({job.texture, job.ticket, job.layer});
+                continue;
+            }
+            // coarsest level first, update() keeps that order per texture
+            const auto level_count = static_cast<std::uint32_t>(baked.levels.size());
+            for (std::uint32_t level = level_count; level-- > 0;) {
+                const TextureBaker::Level& source = baked.levels[level];
+                Staged staged{job.texture, job.ticket, job.layer, baked.format, level, level_count, source.width, source.height,
+                              baked.levels[0].width, baked.levels[0].height, NONE, static_cast<size_t>(source.size), {}};
+                const unsigned char* data = baked.data.data() + source.offset;
+                if (staged.size > TextureStreamer::STAGING_SIZE) {
+                    staged.client.assign(data, data + staged.size);
+                } else {
+                    staged.offset = allocate(lock, staged.size);
+                    if (staged.offset == NONE)
+                        return;
+                    lock.unlock();
+                    std::memcpy(s_mapped + staged.offset, data, staged.size);
+                    lock.lock();
+                }
+                s_staged.push_back(std::move(staged));
+            }
+        }
+    }
+}
+
+void TextureStreamer::init(size_t budget_bytes) {
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &s_pbo);
+    glNamedBufferStorage(s_pbo, static_cast<GLsizeiptr>(STAGING_SIZE), nullptr, flags);
+    s_mapped = static_cast<unsigned char*>(glMapNamedBufferRange(s_pbo, 0, static_cast<GLsizeiptr>(STAGING_SIZE), flags));
+    if (!s_mapped) {
+        Logger::warning("Texture streaming: staging buffer not mappable, loading synchronously");
+        glDeleteBuffers(1, &s_pbo);
+        s_pbo = 0;
+        return;
+    }
+    s_budget = std::max<size_t>(budget_bytes, 1);
+
+    // the baker splits its own work over all cores, a few jobs in flight are enough
+    const unsigned workers = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    for (unsigned i = 0; i < workers; ++i)
+        s_workers.emplace_back(worker);
+    Logger::info("Texture streaming: " + std::to_string(workers) + " workers, " + std::to_string(STAGING_SIZE >> 20)
+                 + " MiB staging, " + std::to_string(s_budget / 1024) + " KiB per frame");
+}
+
+bool TextureStreamer::active() noexcept {
+    return s_pbo != 0;
+}
+
+GLuint TextureStreamer::load(std::vector<unsigned char> bytes, const std::string& name) {
+    GLuint texture = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+    const std::uint64_t ticket = ++s_next_ticket;
+    s_streams[stream_key(texture, -1)] = {ticket, 0, false, name};
+    {
+        std::lock_guard lock(s_mutex);
+        s_jobs.push_back({texture, ticket, std::move(bytes), name});
+    }
+    s_work_ready.notify_one();
+    return texture;
+}
+
+void TextureStreamer::load_layer(GLuint array, std::uint32_t layer, std::uint32_t layer_count, std::uint32_t layer_size,
+                                 std::vector<unsigned char> bytes, const std::string& name) {
+    const auto level_count = static_cast<std::uint32_t>(std::bit_width(layer_size));
+    auto& layers = s_arrays[array];
+    if (layers.empty()) {
+        // immutable storage is always complete (base level is clamped to the last level), the smallest
+        // level of every layer gets a black placeholder before the array is sampled
+        const TextureBaker::Baked black = TextureBaker::placeholder();
+        for (std::uint32_t i = 0; i < layer_count; ++i)
+            TextureBaker::upload_layer(array, static_cast<GLint>(i), black, static_cast<GLint>(level_count - 1));
+        layers.assign(layer_count, level_count - 1);
+        glTextureParameteri(array, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level_count - 1));
+    }
+    const std::uint64_t ticket = ++s_next_ticket;
+    s_streams[stream_key(array, static_cast<std::int32_t>(layer))] = {ticket, level_count, true, name, level_count};
+    {
+        std::lock_guard lock(s_mutex);
+        s_jobs.push_back({array, ticket, std::move(bytes), name, static_cast<std::int32_t>(layer), layer_size});
+    }
+    s_work_ready.notify_one();
+}
+
+void TextureStreamer::cancel(GLuint texture) {
+    s_arrays.erase(texture);
+    if (std::erase_if(s_streams, [&](const auto& stream) { return stream.first >> 32 == texture; }) == 0)
+        return;
+    // staged levels are dropped by update(), their ticket is gone
+    std::lock_guard lock(s_mutex);
+    std::erase_if(s_jobs, [&](const Job& job) { return job.texture == texture; });
+}
+
+void TextureStreamer::update() {
+    if (!s_pbo)
+        return;
+
+    {
+        std::lock_guard lock(s_mutex);
+        bool freed = false;
+        while (!s_regions.empty() && s_regions.front().done) {
+            Region& region = s_regions.front();
+            if (region.fence) {
+                if (glClientWaitSync(region.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                    break;
+                glDeleteSync(region.fence);
+            }
+            s_regions.pop_front();
+            freed = true;
+        }
+        if (freed)
+            s_space_ready.notify_all();
+
+        for (auto& staged : s_staged) {
+            s_queue.push_back(std::move(staged));
+            std::ranges::push_heap(s_queue, later);
+        }
+        s_staged.clear();
+    }
+
+    size_t uploaded = 0;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_pbo);
+    while (!s_queue.empty() && (uploaded < s_budget || uploaded == 0)) {
+        std::ranges::pop_heap(s_queue, later);
+        Staged staged = std::move(s_queue.back());
+        s_queue.pop_back();
+
+        const auto it = s_streams.find(stream_key(staged.texture, staged.layer));
+        if (it == s_streams.end() || it->second.ticket != staged.ticket || staged.level_count == 0
+            || (staged.layer >= 0 && staged.level_count != it->second.level_count)) {
+            if (it != s_streams.end() && it->second.ticket == staged.ticket) {
+                // decode failed, stays without storage - an array layer stays undefined and stops holding the others back
+                if (staged.layer >= 0)
+                    set_layer_level(staged.texture, staged.layer, 0);
+                s_streams.erase(it);
+            }
+            std::lock_guard lock(s_mutex);
+            release(staged, nullptr);
+            continue;
+        }
+        Stream& stream = it->second;
+
+        const GLenum internal = TextureBaker::internal_format(staged.format);
+        if (!stream.allocated) {
+            glTextureStorage2D(staged.texture, static_cast<GLsizei>(staged.level_count), internal,
+                               static_cast<GLsizei>(staged.base_width), static_cast<GLsizei>(staged.base_height));
+            glTextureParameteri(staged.texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(staged.texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(staged.texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTextureParameteri(staged.texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            stream.allocated = true;
+            stream.base_level = staged.level_count;
+        }
+
+        // from the PBO the pointer is an offset
+        if (!staged.client.empty())
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        const void* data = staged.client.empty() ? reinterpret_cast<const void*>(staged.offset) : staged.client.data();
+        if (staged.layer >= 0 && staged.format == TextureBaker::Format::RGBA8)
+            glTextureSubImage3D(staged.texture, static_cast<GLint>(staged.level), 0, 0, staged.layer, static_cast<GLsizei>(staged.width),
+                                static_cast<GLsizei>(staged.height), 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        else if (staged.layer >= 0)
+            glCompressedTextureSubImage3D(staged.texture, static_cast<GLint>(staged.level), 0, 0, staged.layer, static_cast<GLsizei>(staged.width),
+                                          static_cast<GLsizei>(staged.height), 1, internal, static_cast<GLsizei>(staged.size), data);
+        else if (staged.format == TextureBaker::Format::RGBA8)
+            glTextureSubImage2D(staged.texture, static_cast<GLint>(staged.level), 0, 0, static_cast<GLsizei>(staged.width),
+                                static_cast<GLsizei>(staged.height), GL_RGBA, GL_UNSIGNED_BYTE, data);
+        else
+            glCompressedTextureSubImage2D(staged.texture, static_cast<GLint>(staged.level), 0, 0, static_cast<GLsizei>(staged.width),
+                                          static_cast<GLsizei>(staged.height), internal, static_cast<GLsizei>(staged.size), data);
+        if (!staged.client.empty())
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_pbo);
+        else {
+            std::lock_guard lock(s_mutex);
+            release(staged, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        }
+        uploaded += staged.size;
+
+        if (staged.level + 1 == stream.base_level) {
+            stream.base_level = staged.level;
+            if (staged.layer < 0)
+                glTextureParameteri(staged.texture, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(staged.level));
+            else
+                set_layer_level(staged.texture, staged.layer, staged.level);
+        }
+        if (stream.base_level == 0) {
+            Logger::info("Texture streamed: " + stream.name + " " + std::to_string(staged.width) + "x"
+                         + std::to_string(staged.height) + ", " + std::to_string(staged.level_count) + " levels");
+            s_streams.erase(it);
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void TextureStreamer::flush() {
+    if (!s_pbo)
+        return;
+    const size_t budget = s_budget;
+    s_budget = NONE;
+    while (!s_streams.empty()) {
+        update();
+        glFlush(); // upload fences must reach the GPU to free staging space
+        if (!s_streams.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    s_budget = budget;
+}
+
+size_t TextureStreamer::pending() noexcept {
+    return s_streams.size();
+}
+
+void TextureStreamer::clear() {
+    {
+        std::lock_guard lock(s_mutex);
+        s_stop = true;
+        s_jobs.clear();
+    }
+    s_work_ready.notify_all();
+    s_space_ready.notify_all();
+    for (auto& thread : s_workers)
+        thread.join();
+    s_workers.clear();
+
+    for (const Region& region : s_regions)
+        if (region.fence)
+            glDeleteSync(region.fence);
+    s_regions.clear();
+    s_staged.clear();
+    s_queue.clear();
+    s_streams.clear();
+    s_arrays.clear();
+    s_head = 0;
+    s_stop = false;
+
+    if (s_pbo) {
+        glUnmapNamedBuffer(s_pbo);
+        glDeleteBuffers(1, &s_pbo);
+    }
+    s_pbo = 0;
+    s_mapped = nullptr;
+}
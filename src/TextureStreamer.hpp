@@ -0,0 +1,42 @@
+//
+// Created by Daniel Adámek - daniel@nullptr.cz on 2.6.25.
+// Copyright (c) 2025 FM TUL. All rights reserved.
+//
+
+#ifndef TEXTURESTREAMER_HPP
+#define TEXTURESTREAMER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+// asynchronous texture loading
+// - load() returns a texture name at once, workers decode / bake (TextureBaker) and copy the levels
+//   into a persistently mapped staging PBO
+// - update() on the GL thread uploads staged levels smallest first within a per-frame byte budget,
+//   GL_TEXTURE_BASE_LEVEL follows the finest level uploaded so far (1x1 average color first)
+// - until its first level arrives a texture has no storage and samples black
+// - texture array layers (MaterialTextures) stream the same way into storage the caller allocated,
+//   the array's GL_TEXTURE_BASE_LEVEL is the finest level every layer has, a black 1x1 placeholder until then
+class TextureStreamer {
+public:
+    static constexpr size_t STAGING_SIZE = 32u << 20; // larger levels are uploaded from client memory
+
+    static void init(size_t budget_bytes); // after GL init, before the first load
+    static bool active() noexcept;
+
+    static GLuint load(std::vector<unsigned char> bytes, const std::string& name);
+    // layer of a GL_TEXTURE_2D_ARRAY with storage for every level of a TextureBaker::load(bytes, name, layer_size) bake
+    static void load_layer(GLuint array, std::uint32_t layer, std::uint32_t layer_count, std::uint32_t layer_size,
+                           std::vector<unsigned char> bytes, const std::string& name);
+    static void cancel(GLuint texture); // texture (or every layer of an array) deleted before it finished streaming
+
+    static void update(); // once per frame
+    static void flush();  // blocks until every requested texture is complete
+    static size_t pending() noexcept; // textures not yet complete
+
+    static void clear(); // join workers, free the staging buffer - dont put in destructor
+};
+
+#endif //TEXTURESTREAMER_HPP
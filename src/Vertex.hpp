@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
 #include <glm/glm.hpp> 
 
 struct Vertex {
@@ -8,3 +13,44 @@ struct Vertex {
     glm::vec2 m_tex_coords;
 };
 
+// compact GPU vertex, 16 B instead of 32 B
+// - position: 16 bit unorm relative to the mesh AABB (dequantized by uPosScale / uPosOffset)
+// - normal:   GL_INT_2_10_10_10_REV, snorm
+// - uv:       half float
+struct PackedVertex {
+    std::uint16_t m_position[4]; // w unused, keeps the normal 4 B aligned
+    std::uint32_t m_normal;
+    std::uint16_t m_tex_coords[2];
+};
+
+namespace vertex_pack {
+    inline std::uint16_t unorm16(float v) {
+        return static_cast<std::uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    inline std::uint32_t snorm_2_10_10_10(glm::vec3 const & n) {
+        auto snorm10 = [](float v) {
+            return static_cast<std::uint32_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 511.0f)) & 0x3FFu;
+        };
+        return snorm10(n.x) | (snorm10(n.y) << 10) | (snorm10(n.z) << 20);
+    }
+
+    // round to nearest, denormals flush to zero
+    inline std::uint16_t half(float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        const std::uint32_t sign = (bits >> 16) & 0x8000u;
+        const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+        const std::uint32_t mantissa = bits & 0x7FFFFFu;
+
+        if (exponent <= 0)
+            return static_cast<std::uint16_t>(sign);
+        if (exponent >= 31) // overflow, inf and nan
+            return static_cast<std::uint16_t>(sign | 0x7C00u | (((bits >> 23) & 0xFF) == 0xFF && mantissa ? 0x200u : 0u));
+
+        std::uint32_t h = sign | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+        if ((mantissa & 0x1FFFu) > 0x1000u || ((mantissa & 0x1FFFu) == 0x1000u && (h & 1u)))
+            ++h; // carry into the exponent is the correct rounding
+        return static_cast<std::uint16_t>(h);
+    }
+}